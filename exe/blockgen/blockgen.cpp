@@ -5,19 +5,26 @@
 #include "geometry.hpp"
 #include <rnu/camera.hpp>
 #include <iostream>
+#include <fstream>
 #include <array>
 #include <memory>
+#include <optional>
 #include <algorithm>
 #include <unordered_map>
 #include "generic/texture_provider.hpp"
 #include "dynamic_octree.hpp"
+#include "greedy_mesher.hpp"
+#include "chunk_neighborhood.hpp"
 #include "algorithm/perlin.hpp"
+#include "algorithm/heightmap_cache.hpp"
 #include "algorithm/looper.hpp"
 #include <map>
 #include <future>
 #include <thread>
 #include <queue>
 #include "algorithm/cull.hpp"
+#include "hash.hpp"
+#include "profiler.hpp"
 
 #include <shadow.hpp>
 
@@ -93,10 +100,8 @@ void main()
 constexpr auto vertex_shader_source = R"(
 #version 460 core
 
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 normal;
-layout(location = 2) in vec2 uv[3];
-layout(location = 5) in vec4 color;
+layout(location = 0) in uint position_face;
+layout(location = 1) in uint material;
 
 out gl_PerVertex
 {
@@ -109,24 +114,43 @@ layout(std430, binding = 0) buffer Matrices
   mat4 proj;
 };
 
+// All chunks are drawn at once, the base instance of each draw selects its chunk.
+layout(std430, binding = 2) restrict readonly buffer Chunks
+{
+  vec4 chunk_offsets[];
+};
+
+const vec3 face_normals[6] = vec3[6](
+  vec3(1, 0, 0), vec3(-1, 0, 0),
+  vec3(0, 1, 0), vec3(0, -1, 0),
+  vec3(0, 0, 1), vec3(0, 0, -1));
+
 layout(location = 0) out vec3 pass_position;
 layout(location = 1) out vec3 pass_normal;
 layout(location = 2) out vec2 pass_uv[3];
 layout(location = 5) out vec4 pass_color;
 layout(location = 6) out vec3 pass_view_position;
+layout(location = 7) flat out uint pass_material;
 
 void main()
 {
+  vec3 local = vec3(position_face & 63u, (position_face >> 6) & 63u, (position_face >> 12) & 63u);
+  uint face = (position_face >> 18) & 7u;
+  float occlusion = float((position_face >> 21) & 3u) / 3.0;
+
+  vec3 position = chunk_offsets[gl_BaseInstance].xyz + local - 0.5;
   vec4 hom_position = vec4(position, 1);
   pass_view_position = (view * hom_position).xyz;
   gl_Position = proj * view * hom_position;
 
+  vec2 uv = face < 2 ? local.yz : (face < 4 ? local.xz : local.xy);
   pass_position = position;
-  pass_normal = normal;
-  pass_uv[0] = uv[0];
-  pass_uv[1] = uv[1];
-  pass_uv[2] = uv[2];
-  pass_color = color;
+  pass_normal = face_normals[face];
+  pass_uv[0] = uv;
+  pass_uv[1] = uv;
+  pass_uv[2] = uv;
+  pass_color = vec4(vec3(occlusion), 1);
+  pass_material = material;
 }
 )";
 
@@ -137,6 +161,7 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 uv[3];
 layout(location = 5) in vec4 color;
+layout(location = 7) flat in uint material;
 
 
 layout(std430, binding = 0) buffer Matrices
@@ -153,7 +178,8 @@ layout(std430, binding = 1) buffer ShadowMatrices
 
 layout(location = 0) out vec4 out_color;
 
-layout(binding = 0) uniform sampler2D image_texture;
+// One layer per block type, block ids start at 1.
+layout(binding = 0) uniform sampler2DArray image_texture;
 layout(binding = 1) uniform sampler2DShadow shadow_map;
 
 void main()
@@ -165,7 +191,7 @@ void main()
   float shadow = texture(shadow_map, vec3(npos.xy / 2 + 0.5, npos.z));
 
   vec3 ldir = normalize(vec3(1,0.7,0.5));
-  vec3 col = texture(image_texture, uv[0]).rgb;
+  vec3 col = texture(image_texture, vec3(uv[0], float(material - 1))).rgb;
   col = col * max(0, dot(ldir, normalize(normal))) + col * vec3(0.5f, 0.7f, 1.0f);  
 
   vec3 campos = inverse(view)[3].rgb;
@@ -182,14 +208,18 @@ void main()
 }
 )";
 
-std::uint16_t block_at(int x, int y, int z)
+// Blocks above the terrain height are air, whatever the 3D noise at their position.
+bool above_terrain(int y, float perlin)
 {
-  float const perlin = goop::perlin_noise(x / 80.f, 0, z / 80.f, 6, 0.5f);
-  float const perlinx = goop::perlin_noise(x / 50.f, y / 80.f, z / 50.f, 4, 0.5f);
+  return y - (-22 + 120 * (perlin)) > 0;
+}
 
+// Picks the block type from the terrain noise sampled at its position, see chunk::generate.
+std::uint16_t block_from_noise(int y, float perlin, float perlinx, float perlin2)
+{
   float h = y - (-22 + 120 * (perlin));
 
-  if (h > 0)
+  if (above_terrain(y, perlin))
     return 0;
 
   if (perlinx > 0.53 && perlinx < 0.7)
@@ -205,7 +235,6 @@ std::uint16_t block_at(int x, int y, int z)
   if (perlinx > 0.49 && perlinx < 0.75)
     return 3;
 
-  float const perlin2 = goop::perlin_noise(x / 70.f, y / 70.f, z / 70.f);
   return int(3 * perlin2) % 3 + 1;
 }
 
@@ -214,8 +243,9 @@ class vertex_provider
 public:
   struct vertices
   {
-    std::unordered_map<std::uint16_t, std::vector<goop::vertex>> stage_vertices;
-    std::unordered_map<std::uint16_t, std::vector<std::uint32_t>> stage_indices;
+    goop::greedy_mesher mesher;
+    std::vector<goop::voxel_vertex> stage_vertices;
+    std::vector<std::uint32_t> stage_indices;
   };
 
   vertices alloc()
@@ -234,10 +264,8 @@ public:
   void free(vertices&& vert)
   {
     std::unique_lock lock(_mutex);
-    for (auto& [k, v] : vert.stage_vertices)
-      v.clear();
-    for (auto& [k, i] : vert.stage_indices)
-      i.clear();
+    vert.stage_vertices.clear();
+    vert.stage_indices.clear();
     _unused.push_back(std::move(vert));
   }
 
@@ -256,14 +284,6 @@ public:
 
   }
 
-  static bool visible(rnu::mat4 view_projection, float offsetx, float offsety, float offsetz)
-  {
-    rnu::vec3 min{ offsetx , offsety, offsetz };
-    rnu::vec3 max{ offsetx + gen_border_size, offsety + gen_border_size, offsetz + gen_border_size };
-
-    return goop::cull_aabb(view_projection, min, max) != goop::cull_result::fully_outside;
-  }
-
   std::uint16_t block_at(int x, int y, int z) const {
     return _chunk.at(x, y, z);
   }
@@ -272,233 +292,388 @@ public:
   {
     _chunk.emplace(x, y, z, id);
   }
-  
+
   std::size_t border_size() const
   {
     return _chunk.border_size();
   }
 
-  void regenerate(vertex_provider& vertex_provider, float offsetx, float offsety, float offsetz)
+  goop::chunk_border const& border() const
   {
-    auto const block_is_opaque = [&](rnu::vec3i pos)
-    {
-      int const x = pos.x;
-      int const y = pos.y;
-      int const z = pos.z;
-
-      return ::block_at(x, y, z) != 0;
-    };
+    return _border;
+  }
 
-    constexpr std::array const zpos{
-        goop::vertex{.position = {-0.5, -0.5,  0.5}, .normal = { 0, 0, 1 }, .uv = {{0, 0}}, .color = {0, 0, 255, 255} },
-        goop::vertex{.position = {-0.5,  0.5,  0.5}, .normal = { 0, 0, 1 }, .uv = {{0, 1}}, .color = {0, 255, 255, 255} },
-        goop::vertex{.position = { 0.5, -0.5,  0.5}, .normal = { 0, 0, 1 }, .uv = {{1, 0}}, .color = {255, 0, 255, 255} },
-        goop::vertex{.position = { 0.5,  0.5,  0.5}, .normal = { 0, 0, 1 }, .uv = {{1, 1}}, .color = {255, 255, 255, 255} },
-    };
-    constexpr std::array const zneg{
-        goop::vertex{.position = {-0.5, -0.5, -0.5}, .normal = { 0, 0, -1 }, .uv = {{0, 0}}, .color = {0, 0, 255, 255} },
-        goop::vertex{.position = { 0.5, -0.5, -0.5}, .normal = { 0, 0, -1 }, .uv = {{1, 0}}, .color = {255, 0, 255, 255} },
-        goop::vertex{.position = {-0.5,  0.5, -0.5}, .normal = { 0, 0, -1 }, .uv = {{0, 1}}, .color = {0, 255, 255, 255} },
-        goop::vertex{.position = { 0.5,  0.5, -0.5}, .normal = { 0, 0, -1 }, .uv = {{1, 1}}, .color = {255, 255, 255, 255} }
-    };
-    constexpr std::array const ypos{
-        goop::vertex{.position = {-0.5, 0.5, -0.5}, .normal = { 0, 1, 0  }, .uv = {{0, 0}}, .color = {0, 0, 255, 255} },
-        goop::vertex{.position = { 0.5, 0.5, -0.5}, .normal = { 0, 1, 0  }, .uv = {{1, 0}}, .color = {255, 0, 255, 255} },
-        goop::vertex{.position = {-0.5, 0.5,  0.5}, .normal = { 0, 1, 0  }, .uv = {{0, 1}}, .color = {0, 255, 255, 255} },
-        goop::vertex{.position = { 0.5, 0.5,  0.5}, .normal = { 0, 1, 0  }, .uv = {{1, 1}}, .color = {255, 255, 255, 255} },
-    };
-    constexpr std::array const yneg{
-        goop::vertex{.position = {-0.5, -0.5, -0.5}, .normal = { 0, -1, 0 }, .uv = {{0, 0}}, .color = {0, 0, 255, 255} },
-        goop::vertex{.position = {-0.5, -0.5,  0.5}, .normal = { 0, -1, 0 }, .uv = {{0, 1}}, .color = {0, 255, 255, 255} },
-        goop::vertex{.position = { 0.5, -0.5, -0.5}, .normal = { 0, -1, 0 }, .uv = {{1, 0}}, .color = {255, 0, 255, 255} },
-        goop::vertex{.position = { 0.5, -0.5,  0.5}, .normal = { 0, -1, 0 }, .uv = {{1, 1}}, .color = {255, 255, 255, 255} }
-    };
-    constexpr std::array const xpos{
-        goop::vertex{.position = {0.5, -0.5, -0.5}, .normal = { 1, 0, 0 }, .uv = {{0, 0}}, .color = {0, 0, 255, 255} },
-        goop::vertex{.position = {0.5, -0.5,  0.5}, .normal = { 1, 0, 0 }, .uv = {{0, 1}}, .color = {0, 255, 255, 255} },
-        goop::vertex{.position = {0.5,  0.5, -0.5}, .normal = { 1, 0, 0 }, .uv = {{1, 0}}, .color = {255, 0, 255, 255} },
-        goop::vertex{.position = {0.5,  0.5,  0.5}, .normal = { 1, 0, 0 }, .uv = {{1, 1}}, .color = {255, 255, 255, 255} },
-    };
-    constexpr std::array const xneg{
-        goop::vertex{.position = {-0.5, -0.5, -0.5}, .normal = { -1, 0, 0 }, .uv = {{0, 0}}, .color = {0, 0, 255, 255} },
-        goop::vertex{.position = {-0.5,  0.5, -0.5}, .normal = { -1, 0, 0 }, .uv = {{1, 0}}, .color = {255, 0, 255, 255} },
-        goop::vertex{.position = {-0.5, -0.5,  0.5}, .normal = { -1, 0, 0 }, .uv = {{0, 1}}, .color = {0, 255, 255, 255} },
-        goop::vertex{.position = {-0.5,  0.5,  0.5}, .normal = { -1, 0, 0 }, .uv = {{1, 1}}, .color = {255, 255, 255, 255} }
-    };
-    constexpr std::array const indices{
-      0u, 2u, 1u,
-      1u, 2u, 3u
-    };
-    constexpr std::array const faces{
-      zpos,
-      zneg,
-      ypos,
-      yneg,
-      xpos,
-      xneg,
-    };
+  // Heights are the terrain heightmap tile of the chunk column, see terrain_heights.
+  void generate(int chx, int chy, int chz, std::span<float const> heights)
+  {
+    GOOP_PROFILE_ZONE("chunk::generate");
+    auto const base_x = chx * static_cast<int>(border_size());
+    auto const base_y = chy * static_cast<int>(border_size());
+    auto const base_z = chz * static_cast<int>(border_size());
+
+    // Evaluate the terrain noise one row along x at a time, so the batched noise can fill its SIMD lanes.
+    // The 3D noise is only sampled for the blocks of the row below the terrain height, the others are air.
+    int const dim = static_cast<int>(border_size());
+    std::vector<int> columns(dim);
+    std::vector<float> xs(dim);
+    std::vector<float> ys(dim);
+    std::vector<float> zs(dim);
+    std::vector<float> perlinx(dim);
+    std::vector<float> perlin2(dim);
+
+    std::vector<std::uint16_t> blocks(dim * dim * dim);
+    for (int z = 0; z < dim; ++z)
+    {
+      for (int y = 0; y < dim; ++y)
+      {
+        std::size_t count = 0;
+        for (int x = 0; x < dim; ++x)
+        {
+          if (!above_terrain(base_y + y, heights[x + dim * z]))
+            columns[count++] = x;
+        }
+        if (count == 0)
+          continue;
 
-    auto const start_time = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          xs[i] = (base_x + columns[i]) / 50.f;
+          ys[i] = (base_y + y) / 80.f;
+          zs[i] = (base_z + z) / 50.f;
+        }
+        goop::perlin_noise(std::span(xs).first(count), std::span(ys).first(count), std::span(zs).first(count),
+          std::span(perlinx).first(count), 4, 0.5f);
 
-    auto vertex_alloc = vertex_provider.alloc();
-    auto& [stage_vertices, stage_indices] = vertex_alloc;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          xs[i] = (base_x + columns[i]) / 70.f;
+          ys[i] = (base_y + y) / 70.f;
+          zs[i] = (base_z + z) / 70.f;
+        }
+        goop::perlin_noise(std::span(xs).first(count), std::span(ys).first(count), std::span(zs).first(count),
+          std::span(perlin2).first(count));
 
-    for (auto& [key, val] : _block_geometries)
-      val.clear();
-    std::array<goop::vertex, 6 * 6> vertices;
-    std::array<std::uint32_t, 6 * 6> ids;
-    for (int x = 0; x < _chunk.border_size(); ++x)
-    {
-      for (int z = 0; z < _chunk.border_size(); ++z)
-      {
-        for (int y = 0; y < _chunk.border_size(); ++y)
+        for (std::size_t i = 0; i < count; ++i)
         {
-          auto const info = _chunk.info(x, y, z);
-          auto const val = info.value;
-          if (val == 0) {
-            y += info.size - 1;
-            continue;
-          }
-
-          const std::array neighbors{
-            rnu::vec3i{ x, y, z + 1 },
-            rnu::vec3i{ x, y, z - 1 },
-            rnu::vec3i{ x, y + 1, z },
-            rnu::vec3i{ x, y - 1, z },
-            rnu::vec3i{ x + 1, y, z },
-            rnu::vec3i{ x - 1, y, z }, };
-
-          auto* v_insert = vertices.data();
-          auto* i_insert = ids.data();
-
-          for (int i = 0; i < faces.size(); ++i)
-          {
-            auto const base_pos = rnu::vec3{ float(x) + offsetx, float(y) + offsety, float(z) + offsetz };
-            if (block_is_opaque(neighbors[i] + rnu::vec3(offsetx, offsety, offsetz)))
-              continue;
-
-            auto const dist = std::distance(vertices.data(), v_insert);
-
-            for (auto idx : indices)
-            {
-              *i_insert = idx + dist;
-              i_insert++;
-            }
-
-            auto face = faces[i];
-            for (auto& v : face)
-            {
-              v.position = (v.position + rnu::vec3{ float(x) + offsetx, float(y) + offsety, float(z) + offsetz });
-              *v_insert = v;
-              v_insert++;
-            }
-          }
-
-          auto vertex_range = std::span(vertices).subspan(0, std::distance(vertices.data(), v_insert));
-          auto index_range = std::span(ids).subspan(0, std::distance(ids.data(), i_insert));
-
-          if (!vertex_range.empty() && !index_range.empty())
-          {
-            auto& iv = stage_indices[val];
-            auto& vv = stage_vertices[val];
-            for (auto& i : index_range)
-              iv.push_back(i + vv.size());
-            for (auto& v : vertex_range)
-              vv.push_back(v);
-          }
+          auto const x = columns[i];
+          blocks[x + dim * (y + dim * z)] = block_from_noise(base_y + y, heights[x + dim * z], perlinx[i], perlin2[i]);
         }
       }
     }
 
-    _geometry->clear();
-    for (auto& [k, v] : stage_vertices)
-    {
-      if(!v.empty())
-        _block_geometries[k].push_back(_geometry->append_vertices(v, stage_indices[k]));
-    }
-    vertex_provider.free(std::move(vertex_alloc));
+    _chunk.fill(std::span<std::uint16_t const>(blocks));
+    _border = goop::chunk_border(_chunk);
+    _offset = { float(base_x), float(base_y), float(base_z), 0 };
+  }
+
+  chunk(chunk const&) = delete;
+  chunk& operator=(chunk const&) = delete;
+
+  ~chunk()
+  {
+    release_geometry();
+  }
+
+  // The mesh is placed in the geometry shared by all chunks, replacing the previous mesh of this chunk.
+  void regenerate(vertex_provider& vertex_provider, goop::chunk_neighborhood const& neighborhood, goop::voxel_geometry& geometry)
+  {
+    GOOP_PROFILE_ZONE("chunk::regenerate");
+
+    auto vertex_alloc = vertex_provider.alloc();
+    auto& [mesher, stage_vertices, stage_indices] = vertex_alloc;
+
+    mesher.mesh(_chunk, neighborhood);
+    mesher.write_vertices(stage_vertices, stage_indices);
 
-    auto const end_time = std::chrono::steady_clock::now();
-    std::cout << std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time).count() << " seconds for generation\n";
+    // Vertices carry their material and the indices count from the first vertex of the chunk, so one range holds all materials.
+    release_geometry();
+    _geometry = &geometry;
+    _range = geometry->append_vertices(stage_vertices, stage_indices);
+    vertex_provider.free(std::move(vertex_alloc));
   }
 
-  goop::geometry& geometry() { return _geometry; }
+  // Adds the mesh to the culled draws of its geometry and returns the id of the draw, which is its base instance.
+  std::uint32_t add_draw()
+  {
+    rnu::vec3 const min(_offset.x - 0.5f, _offset.y - 0.5f, _offset.z - 0.5f);
+    rnu::vec3 const max = min + rnu::vec3(float(border_size()));
+    _draw = (*_geometry)->add_culled(_range, min, max);
+    return *_draw;
+  }
 
-  std::unordered_map<std::uint16_t, std::vector<goop::vertex_offset>> const& block_geometries() const{ return _block_geometries; }
+  goop::vertex_offset const& range() const { return _range; }
+  rnu::vec4 const& offset() const { return _offset; }
 
 private:
-  goop::geometry _geometry;
-  std::unordered_map<std::uint16_t, std::vector<goop::vertex_offset>> _block_geometries;
+  void release_geometry()
+  {
+    if (_draw)
+      (*_geometry)->remove_culled(*_draw);
+    if (_geometry)
+      (*_geometry)->release(_range);
+    _geometry = nullptr;
+    _draw.reset();
+  }
+
+  goop::voxel_geometry* _geometry = nullptr;
+  goop::vertex_offset _range{};
+  std::optional<std::uint32_t> _draw;
+  rnu::vec4 _offset;
   goop::dynamic_octree<std::uint16_t> _chunk;
+  goop::chunk_border _border;
 };
 
 
+// The terrain height only depends on (x, z), so it is evaluated once per chunk column and shared by all chunks stacked in it.
+void terrain_heights(int tile_x, int tile_z, std::span<float> heights)
+{
+  GOOP_PROFILE_ZONE("terrain_heights");
+  int const dim = chunk::gen_border_size;
+  int const base_x = tile_x * dim;
+  int const base_z = tile_z * dim;
+
+  std::vector<float> xs(dim);
+  std::vector<float> ys(dim, 0.0f);
+  std::vector<float> zs(dim);
+  for (int z = 0; z < dim; ++z)
+  {
+    for (int x = 0; x < dim; ++x)
+    {
+      xs[x] = (base_x + x) / 80.f;
+      zs[x] = (base_z + z) / 80.f;
+    }
+    goop::perlin_noise(xs, ys, zs, heights.subspan(z * dim, dim), 6, 0.5f);
+  }
+}
+
 class world
 {
 public:
-  std::shared_ptr<chunk> at(int x, int y, int z)
+  // Meshed chunks are requested every frame with a priority, lower values are more urgent.
+  // Requests are only collected here, update() starts the most urgent ones.
+  std::shared_ptr<chunk> at(int x, int y, int z, float priority)
   {
     std::tuple index{ x, y, z };
 
     auto val_iter = _chunks.find(index);
-    if (val_iter == _chunks.end())
+    if (val_iter != _chunks.end())
+      return val_iter->second;
+
+    if (_chunk_meshers.contains(index))
+      return nullptr;
+
+    // Meshing looks at the outer blocks of all neighbors, so those are generated first.
+    auto self = generated(x, y, z, priority);
+    std::array neighbors{
+      generated(x + 1, y, z, priority),
+      generated(x - 1, y, z, priority),
+      generated(x, y + 1, z, priority),
+      generated(x, y - 1, z, priority),
+      generated(x, y, z + 1, priority),
+      generated(x, y, z - 1, priority),
+    };
+    if (!self || std::any_of(neighbors.begin(), neighbors.end(), [](auto const& n) { return !n; }))
+      return nullptr;
+
+    request(_mesh_requests, index, priority);
+    return nullptr;
+  }
+
+  goop::voxel_geometry& geometry() { return _geometry; }
+  // The offsets of the meshed chunks, indexed by the base instance of their culled draw.
+  std::span<rnu::vec4 const> draw_offsets() const { return _draw_offsets; }
+
+  // Collects finished jobs, drops everything further than keep_radius chunks away from the center column
+  // (cancelling jobs that are still running) and starts the most urgent requests of this frame.
+  // Requests that were not repeated since the last update are discarded without ever being started.
+  void update(int center_x, int center_z, int keep_radius)
+  {
+    collect(_chunk_loaders, _generated);
+    for (auto const& ch : collect(_chunk_meshers, _chunks))
+    {
+      // Chunks are only drawn from here on, so the draw never sees a stale offset for a reused id.
+      if (ch->range().index_count == 0)
+        continue;
+      auto const id = ch->add_draw();
+      if (_draw_offsets.size() <= id)
+        _draw_offsets.resize(id + 1);
+      _draw_offsets[id] = ch->offset();
+    }
+
+    auto const too_far = [&](int x, int z) {
+      return std::abs(x - center_x) > keep_radius || std::abs(z - center_z) > keep_radius;
+    };
+    auto const evict = [&](auto& map) {
+      std::erase_if(map, [&](auto const& entry) { return too_far(std::get<0>(entry.first), std::get<2>(entry.first)); });
+    };
+    auto const cancel = [&](auto& jobs) {
+      std::erase_if(jobs, [&](auto& entry) {
+        if (!too_far(std::get<0>(entry.first), std::get<2>(entry.first)))
+          return false;
+        entry.second.stop.request_stop();
+        return true;
+        });
+    };
+    evict(_chunks);
+    evict(_generated);
+    cancel(_chunk_loaders);
+    cancel(_chunk_meshers);
+    _heights.erase_if([&](int x, int z) { return too_far(x, z); });
+
+    std::vector<std::tuple<float, bool, std::tuple<int, int, int>>> requests;
+    for (auto const& [index, priority] : _generate_requests)
+      requests.emplace_back(priority, false, index);
+    for (auto const& [index, priority] : _mesh_requests)
+      requests.emplace_back(priority, true, index);
+    _generate_requests.clear();
+    _mesh_requests.clear();
+    std::sort(requests.begin(), requests.end());
+
+    // Only a few jobs are in flight at any time, so that a request made later but closer to the camera
+    // does not queue up behind everything that was requested before. The jobs are scheduled fifo so that
+    // every worker runs them in the order of their priority.
+    for (auto const& [priority, mesh, index] : requests)
+    {
+      if (_chunk_loaders.size() + _chunk_meshers.size() >= max_jobs_in_flight)
+        break;
+
+      if (mesh)
+        start_meshing(index);
+      else
+        start_generating(index);
+    }
+  }
+
+private:
+  static constexpr std::size_t max_jobs_in_flight = 8;
+
+  struct job
+  {
+    std::stop_source stop;
+    std::future<std::shared_ptr<chunk>> result;
+  };
+
+  using chunk_index = std::tuple<int, int, int>;
+
+  struct chunk_index_hash
+  {
+    std::size_t operator()(chunk_index const& index) const
     {
-      auto const iter = _chunk_loaders.find(index);
+      auto const [x, y, z] = index;
+      return goop::hash(x, y, z);
+    }
+  };
+
+  // Lookups happen for every visible chunk coordinate twice per frame, eviction keeps the maps small.
+  template<typename T>
+  using chunk_map = std::unordered_map<chunk_index, T, chunk_index_hash>;
 
-      if (iter == _chunk_loaders.end())
+  static void request(chunk_map<float>& requests, chunk_index index, float priority)
+  {
+    auto [iter, inserted] = requests.emplace(index, priority);
+    if (!inserted)
+      iter->second = std::min(iter->second, priority);
+  }
+
+  // Returns the chunks which were added to finished.
+  static std::vector<std::shared_ptr<chunk>> collect(chunk_map<job>& jobs, chunk_map<std::shared_ptr<chunk>>& finished)
+  {
+    std::vector<std::shared_ptr<chunk>> added;
+    std::erase_if(jobs, [&](auto& entry) {
+      if (!goop::is_ready(entry.second.result))
+        return false;
+      if (auto result = entry.second.result.get())
       {
-        _chunk_loaders.emplace(index, _looper.async([&, x, y, z] {
-          auto v = std::make_shared<chunk>();
-          generate(*v, x, y, z);
-          return v;
-          }));
-        return nullptr;
+        added.push_back(result);
+        finished.emplace(entry.first, std::move(result));
       }
+      return true;
+      });
+    return added;
+  }
 
-      auto& fut = iter->second;
-      if (goop::is_ready(fut))
-      {
-        auto const begin = std::chrono::steady_clock::now();
-        auto [iter, success] = _chunks.emplace(index, std::move(fut.get()));
-        _chunk_loaders.erase(index);
+  std::shared_ptr<chunk> generated(int x, int y, int z, float priority)
+  {
+    std::tuple index{ x, y, z };
 
-        auto const end = std::chrono::steady_clock::now();
-        return iter->second;
-      }
-      else
-      {
+    auto val_iter = _generated.find(index);
+    if (val_iter != _generated.end())
+      return val_iter->second;
+
+    if (!_chunk_loaders.contains(index))
+      request(_generate_requests, index, priority);
+    return nullptr;
+  }
+
+  void start_generating(chunk_index index)
+  {
+    if (_chunk_loaders.contains(index) || _generated.contains(index))
+      return;
+
+    job j;
+    j.result = _looper.async([this, index, stop = j.stop.get_token()]() -> std::shared_ptr<chunk> {
+      if (stop.stop_requested())
         return nullptr;
-      }
-    }
-    return val_iter->second;
+
+      auto const [x, y, z] = index;
+      auto v = std::make_shared<chunk>();
+      v->generate(x, y, z, *_heights.tile(x, z));
+      return v;
+      }, goop::task_order::fifo);
+    _chunk_loaders.emplace(index, std::move(j));
   }
 
-private:
-  void generate(chunk& c, int chx, int chy, int chz)
+  void start_meshing(chunk_index index)
   {
-    auto const base_x = chx * static_cast<int>(c.border_size());
-    auto const base_y = chy * static_cast<int>(c.border_size());
-    auto const base_z = chz * static_cast<int>(c.border_size());
+    if (_chunk_meshers.contains(index) || _chunks.contains(index))
+      return;
 
-    for (int x = 0; x < c.border_size(); ++x)
-      for (int y = 0; y < c.border_size(); ++y)
-        for (int z = 0; z < c.border_size(); ++z)
-        {
-          auto const xr = base_x + x;
-          auto const yr = base_y + y;
-          auto const zr = base_z + z;
+    auto const [x, y, z] = index;
+    auto const find = [&](int x, int y, int z) -> std::shared_ptr<chunk> {
+      auto const iter = _generated.find(std::tuple{ x, y, z });
+      return iter == _generated.end() ? nullptr : iter->second;
+    };
 
-          auto const block = block_at(xr, yr, zr);
-          if(block != 0)
-            c.set_block(x, y, z, block);
-        }
-    c.regenerate(_vertex_provider, base_x, base_y, base_z);
+    // The neighbors may have been evicted since the request was made.
+    auto self = find(x, y, z);
+    std::array neighbors{
+      find(x + 1, y, z),
+      find(x - 1, y, z),
+      find(x, y + 1, z),
+      find(x, y - 1, z),
+      find(x, y, z + 1),
+      find(x, y, z - 1),
+    };
+    if (!self || std::any_of(neighbors.begin(), neighbors.end(), [](auto const& n) { return !n; }))
+      return;
+
+    job j;
+    j.result = _looper.async([this, self = std::move(self), neighbors = std::move(neighbors), stop = j.stop.get_token()]() -> std::shared_ptr<chunk> {
+      if (stop.stop_requested())
+        return nullptr;
+
+      std::array<goop::chunk_border const*, 6> borders{};
+      for (std::size_t i = 0; i < neighbors.size(); ++i)
+        borders[i] = &neighbors[i]->border();
+
+      self->regenerate(_vertex_provider, goop::chunk_neighborhood(self->border_size(), borders), _geometry);
+      return self;
+      }, goop::task_order::fifo);
+    _chunk_meshers.emplace(index, std::move(j));
   }
 
   vertex_provider _vertex_provider;
+  // Chunks release their range on destruction, so the geometry has to outlive the chunk maps and the looper.
+  goop::voxel_geometry _geometry;
+  goop::heightmap_cache<float> _heights{ chunk::gen_border_size, terrain_heights };
   goop::looper _looper{ 4 };
-  std::map<std::tuple<int, int, int>, std::shared_ptr<chunk>> _chunks;
-  std::map<std::tuple<int, int, int>, std::future<std::shared_ptr<chunk>>> _chunk_loaders;
+  chunk_map<std::shared_ptr<chunk>> _chunks;
+  chunk_map<std::shared_ptr<chunk>> _generated;
+  chunk_map<job> _chunk_loaders;
+  chunk_map<job> _chunk_meshers;
+  chunk_map<float> _generate_requests;
+  chunk_map<float> _mesh_requests;
+  std::vector<rnu::vec4> _draw_offsets;
 };
 
 int main()
@@ -512,7 +687,9 @@ int main()
     }, nullptr);
   glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, false);
 
-  std::array<goop::mapped_buffer<matrices>, 2> uniform_buffer = { goop::mapped_buffer<matrices>{1}, goop::mapped_buffer<matrices>{1} };
+  // Per frame uniforms are streamed through a persistently mapped ring instead of mapping a buffer every frame.
+  goop::ring_buffer frame_data;
+  frame_data->reserve(512 * 1024, 3);
 
   std::string info_log;
 
@@ -543,21 +720,54 @@ int main()
 
   world w;
 
-  auto const tex = [&](auto path) {
-    int img_w, img_h, img_comp;
-    stbi_uc* data = stbi_load(path, &img_w, &img_h, &img_comp, 4);
+  // Block textures are the layers of one array texture, so that all materials are drawn without rebinding.
+  // Layer i holds the texture of block id i + 1. Smaller images are scaled up to the largest one.
+  auto const block_texture_array = [&](std::initializer_list<char const*> paths) {
+    struct image
+    {
+      int w;
+      int h;
+      std::vector<std::uint8_t> pixels;
+    };
+    std::vector<image> images;
+    for (auto const path : paths)
+    {
+      int img_w, img_h, img_comp;
+      stbi_uc* data = stbi_load(path, &img_w, &img_h, &img_comp, 4);
+      images.push_back(image{ img_w, img_h, { data, data + img_w * img_h * 4 } });
+      stbi_image_free(data);
+    }
+
+    int layer_w = 1;
+    int layer_h = 1;
+    for (auto const& img : images)
+    {
+      layer_w = std::max(layer_w, img.w);
+      layer_h = std::max(layer_h, img.h);
+    }
 
     goop::texture texture = app.default_texture_provider().acquire(
-      goop::texture_type::t2d, goop::data_type::rgba8unorm, img_w, img_h, goop::compute_texture_mipmap_count);
-    texture->set_data(0, 0, 0, img_w, img_h, 4, { data, data + img_w * img_h * 4 });
+      goop::texture_type::t2d_array, goop::data_type::rgba8unorm, layer_w, layer_h, int(images.size()), goop::compute_texture_mipmap_count);
+    std::vector<std::uint8_t> layer(layer_w * layer_h * 4);
+    for (int i = 0; i < int(images.size()); ++i)
+    {
+      auto const& img = images[i];
+      for (int y = 0; y < layer_h; ++y)
+      {
+        for (int x = 0; x < layer_w; ++x)
+        {
+          auto const src = 4 * ((y * img.h / layer_h) * img.w + x * img.w / layer_w);
+          std::copy_n(std::next(img.pixels.begin(), src), 4, std::next(layer.begin(), 4 * (y * layer_w + x)));
+        }
+      }
+      texture->set_data(0, 0, 0, i, layer_w, layer_h, 1, 4, layer);
+    }
     texture->generate_mipmaps();
-
-    stbi_image_free(data);
     return texture;
   };
 
   goop::sampler sampler;
-  sampler->set_clamp(goop::wrap_mode::clamp_to_edge);
+  sampler->set_clamp(goop::wrap_mode::repeat);
   sampler->set_min_filter(goop::sampler_filter::linear, goop::sampler_filter::linear);
   sampler->set_mag_filter(goop::sampler_filter::linear);
   sampler->set_max_anisotropy(16);
@@ -568,11 +778,11 @@ int main()
   shadow_sampler->set_mag_filter(goop::sampler_filter::linear);
   shadow_sampler->set_compare_fun(goop::compare::less);
 
-  std::unordered_map<std::uint16_t, goop::texture> block_textures{
-    std::pair<std::uint16_t, goop::texture>{1, tex("../../../../../res/dirt.png")},
-    std::pair<std::uint16_t, goop::texture>{2, tex("../../../../../res/grass.jpg")},
-    std::pair<std::uint16_t, goop::texture>{3, tex("../../../../../res/granite.jpg")},
-  };
+  goop::texture block_textures = block_texture_array({
+    "../../../../../res/dirt.png",
+    "../../../../../res/grass.jpg",
+    "../../../../../res/granite.jpg",
+    });
 
   int img = 0;
 
@@ -583,7 +793,6 @@ int main()
   // shadow camera matrix...
   rnu::mat4 sortho = rnu::cameraf::orthographic(-80, 80, -80, 80, -200, 200);
   auto scam = inverse(rnu::rotation(rnu::quat(rnu::vec3(1, 0, 0), rnu::radians(-90.f))));
-  std::array<goop::mapped_buffer<matrices>, 2> camub = { goop::mapped_buffer<matrices>{1}, goop::mapped_buffer<matrices>{1} };
 
   while (app.begin_frame())
   {
@@ -594,26 +803,23 @@ int main()
     auto const view_mat = camera.matrix();
     auto const proj_mat = rnu::cameraf::projection(rnu::radians(60.f), window_width / float(window_height), 0.01f, 1000.f);
 
-    uniform_buffer[img]->map();
-    uniform_buffer[img]->at(0).view = view_mat;
-    uniform_buffer[img]->at(0).proj = proj_mat;
-    uniform_buffer[img]->flush();
-    uniform_buffer[img]->unmap();
+    auto const camera_matrices = frame_data->write(matrices{ .view = view_mat, .proj = proj_mat });
 
     auto& state = app.default_draw_state();
     state->set_depth_test(false);
     background_pipeline->use(background_vs);
     background_pipeline->use(background_fs);
     background_pipeline->bind(state);
-    uniform_buffer[img]->bind(state, 0);
+    frame_data->bind(state, 0, camera_matrices);
     background_geometry->draw(state, background_offset);
     app.default_render_target()->deactivate(state);
 
-    camub[img]->map();
-    camub[img]->at(0).view = scam;
-    camub[img]->at(0).proj = sortho;
-    camub[img]->flush();
-    camub[img]->unmap();
+    auto const shadow_matrices = frame_data->write(matrices{ .view = scam, .proj = sortho });
+
+    rnu::vec3 cam_pos = camera.position() - 0.5f * chunk::gen_border_size;
+    cam_pos /= chunk::gen_border_size;
+    rnu::vec3i cam_posi(cam_pos);
+    constexpr auto radius = 4;
 
     goop::texture shadow_texture;
     for (int i = 0; i < 2; ++i)
@@ -641,39 +847,39 @@ int main()
       pipeline->use(vertex_shader);
       pipeline->use(fragment_shader);
       pipeline->bind(state);
-      (i==0 ? camub : uniform_buffer)[img]->bind(state, 0);
+      frame_data->bind(state, 0, i == 0 ? shadow_matrices : camera_matrices);
       if (i == 1)
-        camub[img]->bind(state, 1);
+        frame_data->bind(state, 1, shadow_matrices);
       sampler->bind(state, 0);
+      block_textures->bind(state, 0);
       if (i == 1)
       {
         shadow_sampler->bind(state, 1);
         shadow_texture->bind(state, 1);
       }
 
-      rnu::vec3 cam_pos = camera.position() - 0.5f * chunk::gen_border_size;
-      cam_pos /= chunk::gen_border_size;
-      rnu::vec3i cam_posi(cam_pos);
-
-      constexpr auto radius = 4;
-      for (int cx = cam_posi.x - radius; cx <= cam_posi.x + radius; ++cx)
+      // Chunks around the camera are requested region by region, see goop::visit_visible_cells.
+      int const first_x = cam_posi.x - radius;
+      int const first_y = -radius;
+      int const first_z = cam_posi.z - radius;
+      rnu::vec3 const grid_origin(float(first_x * chunk::gen_border_size), float(first_y * chunk::gen_border_size), float(first_z * chunk::gen_border_size));
+      goop::visit_visible_cells(goop::extract_frustum(proj * view), grid_origin, float(chunk::gen_border_size), { 2 * radius + 1, 2 * radius + 1, 2 * radius + 1 }, [&](int x, int y, int z) {
+        int const cx = first_x + x;
+        int const cy = first_y + y;
+        int const cz = first_z + z;
+
+        // The nearest chunks in the view frustum are generated and meshed first, chunks which only cast shadows come last.
+        rnu::vec3 const to_camera = rnu::vec3(float(cx), float(cy), float(cz)) - cam_pos;
+        float const shadow_only = i == 0 ? 3.0f * radius * radius : 0.0f;
+        w.at(cx, cy, cz, dot(to_camera, to_camera) + shadow_only);
+        });
+
+      // The meshed chunks are culled against the frustum on the GPU and drawn with one indirect draw,
+      // the per-chunk offsets are indexed by the draw's base instance.
+      if (!w.draw_offsets().empty())
       {
-        for (int cy = -radius; cy <= radius; ++cy)
-        {
-          for (int cz = cam_posi.z - radius; cz <= cam_posi.z + radius; ++cz)
-          {
-            if (chunk::visible(proj * view, cx * chunk::gen_border_size, cy * chunk::gen_border_size, cz * chunk::gen_border_size))
-            {
-              auto ch = w.at(cx, cy, cz);
-              if (ch)
-                for (auto& [block_id, geometries] : ch->block_geometries())
-                {
-                  block_textures[block_id]->bind(state, 0);
-                  ch->geometry()->draw(state, geometries);
-                }
-            }
-          }
-        }
+        frame_data->bind(state, 2, frame_data->write(w.draw_offsets()));
+        w.geometry()->draw_culled(state, pipeline, goop::extract_frustum(proj * view));
       }
 
       if (i == 0)
@@ -689,8 +895,15 @@ int main()
         app.default_render_target()->deactivate(state);
     }
 
+    // Keep a margin around the visible radius, so that chunks at the edge do not get regenerated repeatedly.
+    w.update(cam_posi.x, cam_posi.z, radius + 2);
+
+    frame_data->end_frame();
     img = app.end_frame();
   }
 
+  // The zones of the last frames can be inspected in chrome://tracing or Perfetto.
+  std::ofstream trace("blockgen_trace.json");
+  goop::profiler::instance().write_chrome_trace(trace);
   return 0;
 }
@@ -0,0 +1,82 @@
+#include "algorithm/cull.hpp"
+#include <rnu/camera.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Checks the batched cull_aabbs against the per-corner cull_aabb and compares their throughput.
+int main()
+{
+  constexpr std::size_t box_count = 1 << 20;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+  std::uniform_real_distribution<float> extent(0.5f, 20.0f);
+
+  // An odd count also exercises the scalar tail of the batched path.
+  std::vector<float> min_x(box_count + 3);
+  std::vector<float> min_y(min_x.size());
+  std::vector<float> min_z(min_x.size());
+  std::vector<float> max_x(min_x.size());
+  std::vector<float> max_y(min_x.size());
+  std::vector<float> max_z(min_x.size());
+  for (std::size_t i = 0; i < min_x.size(); ++i)
+  {
+    min_x[i] = position(rng);
+    min_y[i] = position(rng);
+    min_z[i] = position(rng);
+    max_x[i] = min_x[i] + extent(rng);
+    max_y[i] = min_y[i] + extent(rng);
+    max_z[i] = min_z[i] + extent(rng);
+  }
+  goop::aabb_batch const boxes{ min_x, min_y, min_z, max_x, max_y, max_z };
+
+  auto const view_projection = rnu::cameraf::projection(rnu::radians(60.f), 16 / 9.f, 0.01f, 1000.f);
+
+  std::vector<char> per_corner(boxes.size());
+  std::vector<std::uint64_t> visible((boxes.size() + 63) / 64);
+
+  auto const per_corner_begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < boxes.size(); ++i)
+  {
+    per_corner[i] = goop::cull_aabb(view_projection, rnu::vec3(min_x[i], min_y[i], min_z[i]),
+      rnu::vec3(max_x[i], max_y[i], max_z[i])) != goop::cull_result::fully_outside;
+  }
+  auto const per_corner_end = std::chrono::steady_clock::now();
+  goop::cull_aabbs(goop::extract_frustum(view_projection), boxes, visible);
+  auto const batched_end = std::chrono::steady_clock::now();
+
+  std::size_t visible_count = 0;
+  std::size_t mismatches = 0;
+  for (std::size_t i = 0; i < boxes.size(); ++i)
+  {
+    bool const batched = (visible[i / 64] >> (i % 64)) & 1;
+    visible_count += batched;
+    if (batched != bool(per_corner[i]))
+      ++mismatches;
+  }
+
+  auto const boxes_per_second = [&](auto begin, auto end) {
+    return double(boxes.size()) / std::chrono::duration<double>(end - begin).count();
+  };
+  std::cout << "per corner " << boxes_per_second(per_corner_begin, per_corner_end) / 1e6 << " M boxes/s"
+    << ", batched " << boxes_per_second(per_corner_end, batched_end) / 1e6 << " M boxes/s"
+    << ", " << visible_count << " visible, " << mismatches << " mismatches\n";
+
+  bool rejected = false;
+  try
+  {
+    goop::cull_aabbs(goop::extract_frustum(view_projection), boxes, std::span(visible).first(visible.size() - 1));
+  }
+  catch (std::invalid_argument const&)
+  {
+    rejected = true;
+  }
+  if (!rejected)
+    std::cout << "FAILED: short visibility mask was accepted\n";
+
+  return mismatches == 0 && rejected ? 0 : 1;
+}
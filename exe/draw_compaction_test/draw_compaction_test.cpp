@@ -0,0 +1,73 @@
+#include "draw_compaction.hpp"
+#include <rnu/camera.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+  int failures = 0;
+
+  void check(bool condition, char const* what)
+  {
+    if (condition)
+      return;
+    std::cout << "FAILED: " << what << '\n';
+    ++failures;
+  }
+
+  goop::culled_draw make_draw(std::uint32_t first_index, std::uint32_t instance_count, rnu::vec3 min, rnu::vec3 max)
+  {
+    goop::culled_draw draw{};
+    draw.command = goop::draw_info_indexed{ .count = 36, .instance_count = instance_count, .first_index = first_index };
+    draw.bounds_min = rnu::vec4(min.x, min.y, min.z, 1);
+    draw.bounds_max = rnu::vec4(max.x, max.y, max.z, 1);
+    return draw;
+  }
+}
+
+// Runs the CPU reference of the draw compaction on a camera at the origin looking down -z.
+int main()
+{
+  auto const frustum = goop::extract_frustum(rnu::cameraf::projection(rnu::radians(60.f), 1.f, 0.1f, 100.f));
+
+  std::vector<goop::culled_draw> const draws{
+    make_draw(0, 1, { -1, -1, -11 }, { 1, 1, -9 }),       // in front of the camera
+    make_draw(36, 1, { -1, -1, 9 }, { 1, 1, 11 }),        // behind the camera
+    make_draw(72, 0, { -1, -1, -11 }, { 1, 1, -9 }),      // visible but without instances
+    make_draw(108, 2, { 4, -1, -11 }, { 8, 1, -9 }),      // crossing the right plane
+    make_draw(144, 1, { 20, -1, -11 }, { 22, 1, -9 }),    // right of the frustum
+    make_draw(180, 1, { -1, -1, -101 }, { 1, 1, -99 }),   // crossing the far plane
+    make_draw(216, 1, { -1, -1, -130 }, { 1, 1, -120 }),  // beyond the far plane
+    make_draw(252, 1, { -1, 30, -11 }, { 1, 32, -9 }),    // above the frustum
+    make_draw(288, 3, { -100, -100, -50 }, { 100, 100, 50 }), // containing the frustum
+  };
+
+  std::vector<goop::draw_info_indexed> visible(draws.size());
+  auto const count = goop::compact_draws(frustum, draws, visible);
+
+  std::vector<std::uint32_t> const expected_first{ 0, 108, 180, 288 };
+  check(count == expected_first.size(), "visible draw count");
+  for (std::size_t i = 0; i < expected_first.size() && i < count; ++i)
+  {
+    auto const& expected = draws[expected_first[i] / 36].command;
+    check(visible[i].first_index == expected.first_index, "visible draw order");
+    check(visible[i].count == expected.count && visible[i].instance_count == expected.instance_count, "visible draw command");
+  }
+
+  check(goop::compact_draws(frustum, {}, {}) == 0, "empty draw list");
+
+  bool rejected = false;
+  try
+  {
+    goop::compact_draws(frustum, draws, std::span(visible).first(draws.size() - 1));
+  }
+  catch (std::invalid_argument const&)
+  {
+    rejected = true;
+  }
+  check(rejected, "short command span");
+
+  std::cout << failures << " failure(s)\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#include "vectors/font.hpp"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static std::filesystem::path res = std::filesystem::exists("res") ? "res" : RESOURCE_DIRECTORY;
+
+// Checks the decoded cmap table against parsing the cmap on every lookup and compares their throughput.
+int main(int argc, char** argv)
+{
+  goop::font_accessor const font(argc > 1 ? std::filesystem::path(argv[1]) : res / "SawarabiGothic-Regular.ttf");
+
+  std::size_t mismatches = 0;
+  for (char32_t character = 0; character < 0x20000; ++character)
+  {
+    if (font.index_of(character) != font.decode_index(character))
+      ++mismatches;
+  }
+
+  // Latin, kana and kanji, as in the text the model viewer renders.
+  std::u32string const text = U"The quick brown fox jumps over the lazy dog. 0123456789 \u3042\u3044\u3046\u30a2\u30a4\u65e5\u672c\u8a9e";
+  constexpr int repetitions = 20000;
+
+  auto const lookups_per_second = [&](auto&& lookup) {
+    std::uint64_t sum = 0;
+    auto const begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+    {
+      for (auto const character : text)
+        sum += static_cast<std::uint64_t>(lookup(character));
+    }
+    auto const end = std::chrono::steady_clock::now();
+    return std::pair{ double(repetitions * text.size()) / std::chrono::duration<double>(end - begin).count(), sum };
+  };
+
+  auto const [table, table_sum] = lookups_per_second([&](char32_t c) { return font.index_of(c); });
+  auto const [parse, parse_sum] = lookups_per_second([&](char32_t c) { return font.decode_index(c); });
+  if (table_sum != parse_sum)
+    ++mismatches;
+
+  std::cout << "table " << table / 1e6 << " M lookups/s"
+    << ", parse " << parse / 1e6 << " M lookups/s"
+    << ", " << mismatches << " mismatches\n";
+  return mismatches == 0 ? 0 : 1;
+}
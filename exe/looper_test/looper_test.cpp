@@ -0,0 +1,131 @@
+#include "algorithm/looper.hpp"
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+  int failures = 0;
+
+  void check(bool condition, char const* what)
+  {
+    if (condition)
+      return;
+    std::cout << "FAILED: " << what << '\n';
+    ++failures;
+  }
+
+  template<typename R>
+  bool finishes(std::future<R> const& f)
+  {
+    return f.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+  }
+}
+
+int main()
+{
+  {
+    goop::looper looper(4);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 1000; ++i)
+      results.push_back(looper.async([i] { return 2 * i; }));
+
+    long sum = 0;
+    for (auto& r : results)
+      sum += r.get();
+    check(sum == 999 * 1000, "async results");
+
+    auto failing = looper.async([]() -> int { throw std::runtime_error("expected"); });
+    bool thrown = false;
+    try { failing.get(); }
+    catch (std::runtime_error const&) { thrown = true; }
+    check(thrown, "async exception");
+  }
+
+  // fifo tasks of a worker run in the order they were scheduled, lifo tasks newest first.
+  {
+    goop::looper looper(1);
+    std::promise<void> gate;
+    auto const opened = gate.get_future().share();
+    auto const blocker = looper.async([opened] { opened.wait(); });
+
+    std::mutex mtx;
+    std::vector<int> order;
+    std::vector<std::future<void>> done;
+    for (int i = 0; i < 4; ++i)
+      done.push_back(looper.async([&, i] { std::unique_lock lock(mtx); order.push_back(i); }, goop::task_order::fifo));
+    for (int i = 4; i < 6; ++i)
+      done.push_back(looper.async([&, i] { std::unique_lock lock(mtx); order.push_back(i); }));
+    gate.set_value();
+
+    bool finished = finishes(blocker);
+    for (auto const& d : done)
+      finished = finished && finishes(d);
+    check(finished, "ordered tasks finish");
+    check(order == std::vector<int>{ 5, 4, 0, 1, 2, 3 }, "task order");
+  }
+
+  // A worker that runs dry steals the fifo tasks of another worker in the order they were scheduled as well.
+  {
+    goop::looper looper(2);
+    std::array<std::promise<void>, 2> started;
+    std::array<std::promise<void>, 2> gates;
+    std::vector<std::future<void>> blockers;
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+      blockers.push_back(looper.async([&, i, opened = gates[i].get_future().share()] {
+        started[i].set_value();
+        opened.wait();
+        }));
+    }
+    for (auto& s : started)
+      s.get_future().wait();
+
+    // Both workers are blocked, so the tasks alternate between their queues.
+    std::mutex mtx;
+    std::vector<int> order;
+    std::vector<std::future<void>> done;
+    for (int i = 0; i < 6; ++i)
+      done.push_back(looper.async([&, i] { std::unique_lock lock(mtx); order.push_back(i); }, goop::task_order::fifo));
+
+    // The second worker runs its own tasks and then steals those queued behind the blocked first worker.
+    gates[1].set_value();
+    bool finished = true;
+    for (auto const& d : done)
+      finished = finished && finishes(d);
+    gates[0].set_value();
+    for (auto const& b : blockers)
+      finished = finished && finishes(b);
+    check(finished, "stolen tasks finish");
+    check(order == std::vector<int>{ 1, 3, 5, 0, 2, 4 }, "stolen task order");
+  }
+
+  // A continuation deferred while all workers sleep has to be polled until its dependency is ready.
+  for (int run = 0; run < 50; ++run)
+  {
+    goop::looper looper(4);
+    std::promise<int> promise;
+    auto const dependency = promise.get_future().share();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    auto continuation = looper.then(dependency, [](int value) { return value + 1; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    promise.set_value(41);
+
+    if (!finishes(continuation))
+    {
+      check(false, "continuation after idle workers");
+      // The looper cannot be joined if a worker never picks the continuation up.
+      std::cout << failures << " failure(s)\n";
+      std::exit(1);
+    }
+    check(continuation.get() == 42, "continuation result");
+  }
+
+  std::cout << failures << " failure(s)\n";
+  return failures == 0 ? 0 : 1;
+}
@@ -222,6 +222,14 @@ public:
     add_component_type<material_component>();
     add_component_type<geometry_component>();
     add_component_type<parented_to_component>(rnu::component_flag::optional);
+    reserve_objects(256);
+  }
+
+  // Every drawn object gets its own transform slot, which may be reused once the GPU finished the frame.
+  void end_frame()
+  {
+    _object_transforms->end_frame();
+    _frame_objects = 0;
   }
 
   void set_draw_state(goop::draw_state& state)
@@ -248,12 +256,15 @@ public:
     if (skeleton_tf)
       model_mat = skeleton_tf->create_matrix() * model_mat;
 
-    _object_transform->write(object_transform{
+    if (++_frame_objects > _object_capacity)
+      reserve_objects(2 * _object_capacity);
+
+    auto const object = _object_transforms->write(object_transform{
       .transform = model_mat,
       .animated = skeleton && skeleton->animations.contains(skeleton->active_animation)
       });
     material->material.bind(*_draw_state);
-    _object_transform->bind(*_draw_state, 3);
+    _object_transforms->bind(*_draw_state, 3, object);
     geometry->geometry->draw(*_draw_state, geometry->parts);
   }
 
@@ -263,7 +274,20 @@ private:
     rnu::mat4 transform;
     int32_t animated;
   };
-  mutable goop::mapped_buffer<object_transform> _object_transform;
+
+  static constexpr std::size_t frames_in_flight = 3;
+
+  // Makes room for the slots of object_count objects in every frame in flight and the one being recorded.
+  // Growing waits for the frames in flight, so it only happens when a frame draws more objects than ever before.
+  void reserve_objects(std::size_t object_count) const
+  {
+    _object_capacity = object_count;
+    _object_transforms->reserve(object_count * goop::ring_buffer_base::default_alignment * (frames_in_flight + 1), frames_in_flight);
+  }
+
+  mutable goop::ring_buffer _object_transforms;
+  mutable std::size_t _object_capacity = 0;
+  mutable std::size_t _frame_objects = 0;
   goop::draw_state* _draw_state;
 };
 
@@ -1364,14 +1388,14 @@ int main()
     stbi_info("../../../../../res/testsmall.jpg", &iiix, &iiiy, &iiich);
     add(rnu::rect2f{ {0,0}, {iiix, iiiy} }, raster_image{ "../../../../../res/testsmall.jpg" });
 
-    const std::pair<char16_t, char16_t> char_ranges[] = {
+    const std::pair<char32_t, char32_t> char_ranges[] = {
       goop::character_ranges::basic_latin,
       goop::character_ranges::c1_controls_and_latin_1_supplement,
     };
 
     for (auto p : char_ranges)
     {
-      for (char16_t x = p.first; x <= p.second; ++x)
+      for (char32_t x = p.first; x <= p.second; ++x)
       {
         auto const gly = fnt.glyph(x);
         if (gly == goop::glyph_id::missing)
@@ -1839,6 +1863,7 @@ int main()
 
     el::draw_root(root_frame, state, app.default_render_target(), window_width, window_height);
 
+    object_renderer.end_frame();
     img = app.end_frame();
   }
 }
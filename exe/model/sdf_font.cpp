@@ -1,17 +1,45 @@
 #include "sdf_font.hpp"
 #include <vectors/skyline_packer.hpp>
+#include <profiler.hpp>
 #include <algorithm>
 #include <execution>
 
 namespace goop::gui
 {
-  sdf_font::sdf_font(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char16_t, char16_t> const> unicode_ranges)
+  namespace
+  {
+    // Reads the code point at position and moves past it. Where wchar_t is 16 bits wide it holds UTF-16,
+    // so a surrogate pair is combined into one code point.
+    char32_t next_code_point(std::wstring_view str, std::size_t& position)
+    {
+      auto const c = static_cast<char32_t>(str[position++]);
+      if constexpr (sizeof(wchar_t) == 2)
+      {
+        if (c >= 0xD800 && c < 0xDC00 && position < str.size())
+        {
+          auto const low = static_cast<char32_t>(str[position]);
+          if (low >= 0xDC00 && low < 0xE000)
+          {
+            ++position;
+            return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+          }
+        }
+      }
+      return c;
+    }
+  }
+
+  sdf_font::sdf_font(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char32_t, char32_t> const> unicode_ranges)
   {
     (*this)->load(atlas_width, base_size, sdf_width, std::move(font), std::move(unicode_ranges));
   }
-  void sdf_font_base::load(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char16_t, char16_t> const> unicode_ranges)
+  void sdf_font_base::load(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char32_t, char32_t> const> unicode_ranges)
   {
     _font = std::move(font);
+    if (auto const ligatures = _font->query_feature(goop::font_feature_type::substitution, goop::font_script::scr_latin, goop::font_language::lang_default, goop::font_feature::ft_liga))
+      _ligatures = _font->compile_feature(*ligatures);
+    if (auto const kerning = _font->query_feature(goop::font_feature_type::positioning, goop::font_script::scr_latin, goop::font_language::lang_default, goop::font_feature::ft_kern))
+      _kerning = _font->compile_feature(*kerning);
     _base_size = base_size;
     _sdf_width = sdf_width;
     _width = atlas_width;
@@ -22,7 +50,7 @@ namespace goop::gui
 
     for (auto p : unicode_ranges)
     {
-      for (char16_t x = p.first; x <= p.second; ++x)
+      for (char32_t x = p.first; x <= p.second; ++x)
       {
         auto const gly = _font->glyph(x);
         if (gly == goop::glyph_id::missing)
@@ -80,6 +108,7 @@ namespace goop::gui
   }
   void sdf_font_base::dump(std::vector<std::uint8_t>& image, int& w, int& h) const
   {
+    GOOP_PROFILE_ZONE("sdf_font::bake");
     w = _width;
     h = _height + 1;
     image.resize(w * h);
@@ -150,87 +179,65 @@ namespace goop::gui
 
     return letter;
   }
-  std::optional<glyph_id> sdf_font_base::ligature(goop::font const& font, goop::font_feature_info const& lig_feature, std::span<goop::glyph_id const> glyphs)
-  {
-    auto const feat_result = font.lookup_substitution(lig_feature, glyphs);
-    if (!feat_result)
-      return std::nullopt;
-
-    auto const count = font.substitution_count(*feat_result);
-    if (count != 1)
-      return std::nullopt;
-
-    return font.substitution_glyph(*feat_result, 0);
-  }
   std::vector<sdf_font_base::set_glyph_t> sdf_font_base::text_set(std::wstring_view str, int *num_lines, float* x_max)
   {
     rnu::vec2 cursor{ 0, 0 };
-    auto ligature_feature = _font->query_feature(goop::font_feature_type::substitution, goop::font_script::scr_latin, goop::font_language::lang_default, goop::font_feature::ft_liga);
-    auto kerning_feature = _font->query_feature(goop::font_feature_type::positioning, goop::font_script::scr_latin, goop::font_language::lang_default, goop::font_feature::ft_kern);
 
-    thread_local static std::vector<std::vector<goop::glyph_id>> glyph_lines;
-    glyph_lines.clear();
-    glyph_lines.emplace_back();
-    for (auto& c : str)
+    // Shape all lines in a single left to right pass. At every position the longest ligature starting there replaces
+    // its components, each output glyph keeps the index of the first source character it was formed from.
+    thread_local static std::vector<goop::glyph_id> line_glyphs;
+    thread_local static std::vector<std::size_t> line_clusters;
+    thread_local static std::vector<std::size_t> line_ends;
+    line_ends.clear();
+
+    std::vector<set_glyph_t> set_glyphs;
+    set_glyphs.reserve(str.size());
+    for (std::size_t line_begin = 0; line_begin <= str.size();)
     {
-      if (c == '\n')
+      auto const line_end = std::min(str.find(L'\n', line_begin), str.size());
+
+      line_glyphs.clear();
+      line_clusters.clear();
+      for (auto c = line_begin; c < line_end;)
       {
-        glyph_lines.emplace_back();
-        continue;
+        line_clusters.push_back(c);
+        line_glyphs.push_back(_font->glyph(next_code_point(str, c)));
       }
-      glyph_lines.back().push_back(_font->glyph(c));
-    }
-
-    bool has_substituted = true;
-    auto const font_scale = _base_size / _font->units_per_em();
 
-    while (has_substituted)
-    {
-      has_substituted = false;
-      for (auto& glyphs : glyph_lines)
+      for (std::size_t i = 0; i < line_glyphs.size();)
       {
-        for (int i = 0; i < glyphs.size() - 1; ++i)
-        {
-          auto const second = glyphs.size() - 1 - i;
-          auto const first = second - 1;
-
-          auto sub = (i < glyphs.size() - 2) && ligature_feature ? ligature(*_font, *ligature_feature, std::array{ glyphs[first - 1], glyphs[first], glyphs[second] }) : std::nullopt;
-          if (!sub && ligature_feature)
-            sub = ligature(*_font, *ligature_feature, std::array{ glyphs[first], glyphs[second] });
-          if (sub)
-          {
-            has_substituted = true;
-            glyphs[first] = *sub;
-            glyphs.erase(glyphs.begin() + second);
-          }
-        }
+        auto const match = _ligatures ? _ligatures->longest_ligature(std::span(line_glyphs).subspan(i)) : std::nullopt;
+        auto& result = set_glyphs.emplace_back();
+        result.glyph = match ? match->glyph : line_glyphs[i];
+        result.cluster = line_clusters[i];
+        i += match ? match->length : 1;
       }
-    }
 
-    std::vector<set_glyph_t> set_glyphs(std::accumulate(begin(glyph_lines), end(glyph_lines), 0ull, [](auto const& val, auto& v) { return val + v.size(); }));
+      line_ends.push_back(set_glyphs.size());
+      line_begin = line_end + 1;
+    }
 
+    auto const font_scale = _base_size / _font->units_per_em();
     auto const basey = 40;
     auto const rad = 0.5f;
 
     if (x_max)
       *x_max = 0;
 
-    int base_i = 0;
+    std::size_t line_begin = 0;
     float base_x = cursor.x;
-    for (auto const& glyphs : glyph_lines)
+    for (auto const line_end : line_ends)
     {
-      for (int i = 0; i < glyphs.size(); ++i)
+      for (auto i = line_begin; i < line_end; ++i)
       {
-        auto const gly = glyphs[i];
-        auto& result = set_glyphs[base_i + i];
-        result.glyph = gly;
+        auto& result = set_glyphs[i];
+        auto const gly = result.glyph;
         auto const rec = _font->get_rect(gly);
 
-        auto const next_glyph = i < glyphs.size() - 1 ? glyphs[i + 1] : goop::glyph_id::missing;
-
-        auto const kerning = !kerning_feature ? std::nullopt : _font->lookup_positioning(*kerning_feature, std::array{ gly, next_glyph });
+        auto const next_glyph = i + 1 < line_end ? set_glyphs[i + 1].glyph : goop::glyph_id::missing;
 
-        auto const kerning_values = !kerning ? nullptr : std::get_if<font_accessor::pair_value_feature>(&*kerning);
+        auto const kerning = !_kerning ? std::nullopt : _kerning->kerning(gly, next_glyph);
+        auto const kerning_values = !kerning ? nullptr : &*kerning;
 
         auto [ad1, be1] = _font->advance_bearing(gly);
 
@@ -260,7 +267,7 @@ namespace goop::gui
 
       if (x_max)
         *x_max = std::max(*x_max, cursor.x);
-      base_i += glyphs.size();
+      line_begin = line_end;
       cursor.x = base_x;
       cursor.y -= (_font->ascent() - _font->descent()) * font_scale;
       if (num_lines) ++*num_lines;
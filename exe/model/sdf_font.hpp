@@ -19,6 +19,8 @@ namespace goop::gui
     struct set_glyph_t
     {
       glyph_id glyph;
+      // Index of the first character in the source text this glyph was shaped from.
+      std::size_t cluster;
       rnu::rect2f bounds;
       rnu::rect2f uvs;
     };
@@ -33,14 +35,13 @@ namespace goop::gui
     font const& font() const;
 
   private:
-    void load(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char16_t, char16_t> const> unicode_ranges);
+    void load(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char32_t, char32_t> const> unicode_ranges);
     void dump(std::vector<std::uint8_t>& image, int& w, int& h) const;
     std::vector<goop::lines::line> const& load_glyph(glyph_id glyph) const;
-    std::optional<glyph_id> ligature(goop::font const& font, goop::font_feature_info const& lig_feature, std::span<goop::glyph_id const> glyphs);
 
     struct glyph_info
     {
-      char16_t character;
+      char32_t character;
       goop::glyph_id id;
       float scale;
       rnu::rect2f default_bounds;
@@ -50,6 +51,8 @@ namespace goop::gui
     };
 
     std::optional<goop::font> _font;
+    std::optional<goop::compiled_feature> _ligatures;
+    std::optional<goop::compiled_feature> _kerning;
     float _base_size = 0;
     float _sdf_width = 0;
     int _width = 0;
@@ -62,6 +65,6 @@ namespace goop::gui
   class sdf_font : public goop::handle<sdf_font_base, sdf_font_base> 
   {
   public:
-    sdf_font(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char16_t, char16_t> const> unicode_ranges);
+    sdf_font(int atlas_width, float base_size, float sdf_width, goop::font font, std::span<std::pair<char32_t, char32_t> const> unicode_ranges);
   };
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "algorithm/perlin.hpp"
+#include <bit>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Checks the batched perlin_noise against the scalar function bit for bit and compares their throughput.
+int main()
+{
+  constexpr std::size_t sample_count = 1 << 20;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+
+  // An odd count also exercises the scalar tail of the batched path.
+  std::vector<float> x(sample_count + 3);
+  std::vector<float> y(x.size());
+  std::vector<float> z(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i)
+  {
+    x[i] = coordinate(rng);
+    y[i] = coordinate(rng);
+    z[i] = coordinate(rng);
+  }
+
+  std::vector<float> scalar(x.size());
+  std::vector<float> batched(x.size());
+
+  int failures = 0;
+  for (int const octaves : { 1, 4, 6 })
+  {
+    auto const scalar_begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < x.size(); ++i)
+      scalar[i] = goop::perlin_noise(x[i], y[i], z[i], octaves, 0.5f);
+    auto const scalar_end = std::chrono::steady_clock::now();
+    goop::perlin_noise(x, y, z, batched, octaves, 0.5f);
+    auto const batched_end = std::chrono::steady_clock::now();
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < x.size(); ++i)
+    {
+      if (std::bit_cast<std::uint32_t>(scalar[i]) != std::bit_cast<std::uint32_t>(batched[i]))
+        ++mismatches;
+    }
+
+    auto const samples_per_second = [&](auto begin, auto end) {
+      return double(x.size()) / std::chrono::duration<double>(end - begin).count();
+    };
+    std::cout << "octaves " << octaves
+      << ": scalar " << samples_per_second(scalar_begin, scalar_end) / 1e6 << " M samples/s"
+      << ", batched " << samples_per_second(scalar_end, batched_end) / 1e6 << " M samples/s"
+      << ", " << mismatches << " mismatches\n";
+
+    if (mismatches != 0)
+      ++failures;
+  }
+  return failures == 0 ? 0 : 1;
+}
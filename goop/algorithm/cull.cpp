@@ -0,0 +1,139 @@
+#include "cull.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GOOP_CULL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GOOP_CULL_SSE2 1
+#endif
+
+namespace goop
+{
+  namespace
+  {
+    float plane_distance(rnu::vec4 const& plane, float x, float y, float z)
+    {
+      return plane.x * x + plane.y * y + plane.z * z + plane.w;
+    }
+
+#if GOOP_CULL_AVX
+    struct lanes
+    {
+      static constexpr std::size_t width = 8;
+      using f = __m256;
+
+      static f load(float const* p) { return _mm256_loadu_ps(p); }
+      static f set(float v) { return _mm256_set1_ps(v); }
+      static f add(f a, f b) { return _mm256_add_ps(a, b); }
+      static f mul(f a, f b) { return _mm256_mul_ps(a, b); }
+      static f less(f a, f b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+      static f bit_or(f a, f b) { return _mm256_or_ps(a, b); }
+      static std::uint32_t mask(f a) { return std::uint32_t(_mm256_movemask_ps(a)); }
+    };
+#elif GOOP_CULL_SSE2
+    struct lanes
+    {
+      static constexpr std::size_t width = 4;
+      using f = __m128;
+
+      static f load(float const* p) { return _mm_loadu_ps(p); }
+      static f set(float v) { return _mm_set1_ps(v); }
+      static f add(f a, f b) { return _mm_add_ps(a, b); }
+      static f mul(f a, f b) { return _mm_mul_ps(a, b); }
+      static f less(f a, f b) { return _mm_cmplt_ps(a, b); }
+      static f bit_or(f a, f b) { return _mm_or_ps(a, b); }
+      static std::uint32_t mask(f a) { return std::uint32_t(_mm_movemask_ps(a)); }
+    };
+#endif
+  }
+
+  frustum extract_frustum(rnu::mat4 const& view_projection)
+  {
+    // The rows of the matrix, obtained without relying on its storage order.
+    rnu::vec4 const x = view_projection * rnu::vec4(1, 0, 0, 0);
+    rnu::vec4 const y = view_projection * rnu::vec4(0, 1, 0, 0);
+    rnu::vec4 const z = view_projection * rnu::vec4(0, 0, 1, 0);
+    rnu::vec4 const w = view_projection * rnu::vec4(0, 0, 0, 1);
+    auto const row = [&](int r) { return rnu::vec4(x[r], y[r], z[r], w[r]); };
+
+    // -w <= x, y, z <= w in clip space.
+    frustum result{};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      result.planes[axis * 2 + 0] = row(3) + row(axis);
+      result.planes[axis * 2 + 1] = row(3) - row(axis);
+    }
+    return result;
+  }
+
+  cull_result cull_aabb(frustum const& frustum, rnu::vec3 min, rnu::vec3 max)
+  {
+    cull_result result = cull_result::fully_inside;
+    for (auto const& plane : frustum.planes)
+    {
+      // The corner furthest along the plane normal decides whether the box is outside,
+      // the opposite corner whether it is fully inside.
+      float const outer = plane_distance(plane,
+        plane.x >= 0 ? max.x : min.x,
+        plane.y >= 0 ? max.y : min.y,
+        plane.z >= 0 ? max.z : min.z);
+      if (outer < 0)
+        return cull_result::fully_outside;
+
+      float const inner = plane_distance(plane,
+        plane.x >= 0 ? min.x : max.x,
+        plane.y >= 0 ? min.y : max.y,
+        plane.z >= 0 ? min.z : max.z);
+      if (inner < 0)
+        result = cull_result::intersecting;
+    }
+    return result;
+  }
+
+  void cull_aabbs(frustum const& frustum, aabb_batch const& boxes, std::span<std::uint64_t> visible)
+  {
+    for (auto const& coordinates : { boxes.min_y, boxes.min_z, boxes.max_x, boxes.max_y, boxes.max_z })
+    {
+      if (coordinates.size() < boxes.size())
+        throw std::invalid_argument("All bounding box coordinates must have the same size.");
+    }
+    if (visible.size() < (boxes.size() + 63) / 64)
+      throw std::invalid_argument("Visibility mask must hold one bit per bounding box.");
+
+    std::fill(visible.begin(), visible.end(), 0);
+    std::size_t i = 0;
+
+#if GOOP_CULL_AVX || GOOP_CULL_SSE2
+    using L = lanes;
+    for (; i + L::width <= boxes.size(); i += L::width)
+    {
+      auto const zero = L::set(0.0f);
+      auto outside = zero;
+      for (auto const& plane : frustum.planes)
+      {
+        auto const px = L::load(&(plane.x >= 0 ? boxes.max_x : boxes.min_x)[i]);
+        auto const py = L::load(&(plane.y >= 0 ? boxes.max_y : boxes.min_y)[i]);
+        auto const pz = L::load(&(plane.z >= 0 ? boxes.max_z : boxes.min_z)[i]);
+
+        auto const distance = L::add(L::add(L::add(L::mul(L::set(plane.x), px), L::mul(L::set(plane.y), py)), L::mul(L::set(plane.z), pz)), L::set(plane.w));
+        outside = L::bit_or(outside, L::less(distance, zero));
+      }
+
+      // Groups never straddle two words, since 64 is a multiple of the lane count.
+      std::uint64_t const inside = ~L::mask(outside) & ((1u << L::width) - 1);
+      visible[i / 64] |= inside << (i % 64);
+    }
+#endif
+
+    for (; i < boxes.size(); ++i)
+    {
+      rnu::vec3 const min(boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]);
+      rnu::vec3 const max(boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]);
+      if (cull_aabb(frustum, min, max) != cull_result::fully_outside)
+        visible[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+  }
+}
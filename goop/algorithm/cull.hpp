@@ -1,6 +1,11 @@
 #pragma once
 
 #include <rnu/math/math.hpp>
+#include <array>
+#include <span>
+#include <cstdint>
+#include <concepts>
+#include <algorithm>
 
 namespace goop
 {
@@ -50,4 +55,86 @@ namespace goop
     }
     return result;
   }
+
+  // The 6 clip planes of a view projection as (a, b, c, d) with a*x + b*y + c*z + d >= 0 inside.
+  // Extracting them once per view lets every AABB test run without transforming its corners.
+  struct frustum
+  {
+    std::array<rnu::vec4, 6> planes;
+  };
+
+  frustum extract_frustum(rnu::mat4 const& view_projection);
+  cull_result cull_aabb(frustum const& frustum, rnu::vec3 min, rnu::vec3 max);
+
+  // Structure-of-arrays bounding boxes, all spans have the same size.
+  struct aabb_batch
+  {
+    std::span<float const> min_x;
+    std::span<float const> min_y;
+    std::span<float const> min_z;
+    std::span<float const> max_x;
+    std::span<float const> max_y;
+    std::span<float const> max_z;
+
+    std::size_t size() const { return min_x.size(); }
+  };
+
+  // Sets bit (i % 64) of visible[i / 64] if box i is not fully outside of the frustum, and clears it otherwise.
+  // Tests 8 boxes at a time with AVX or 4 with SSE if the target supports them.
+  void cull_aabbs(frustum const& frustum, aabb_batch const& boxes, std::span<std::uint64_t> visible);
+
+  namespace detail
+  {
+    template<typename Visitor>
+    void visit_visible_cells(frustum const& frustum, rnu::vec3 origin, float cell_size, std::array<int, 3> const& cells,
+      std::array<int, 3> const& base, int size, bool inside, Visitor& visitor)
+    {
+      std::array<int, 3> end{};
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        end[axis] = std::min(base[axis] + size, cells[axis]);
+        if (end[axis] <= base[axis])
+          return;
+      }
+
+      if (!inside)
+      {
+        rnu::vec3 const min(origin.x + cell_size * base[0], origin.y + cell_size * base[1], origin.z + cell_size * base[2]);
+        rnu::vec3 const max(origin.x + cell_size * end[0], origin.y + cell_size * end[1], origin.z + cell_size * end[2]);
+        auto const result = cull_aabb(frustum, min, max);
+        if (result == cull_result::fully_outside)
+          return;
+        inside = result == cull_result::fully_inside;
+      }
+
+      if (inside || size == 1)
+      {
+        for (int x = base[0]; x < end[0]; ++x)
+          for (int y = base[1]; y < end[1]; ++y)
+            for (int z = base[2]; z < end[2]; ++z)
+              visitor(x, y, z);
+        return;
+      }
+
+      int const half = size / 2;
+      for (int i = 0; i < 8; ++i)
+      {
+        std::array const child{ base[0] + (i & 1) * half, base[1] + ((i >> 1) & 1) * half, base[2] + ((i >> 2) & 1) * half };
+        visit_visible_cells(frustum, origin, cell_size, cells, child, half, false, visitor);
+      }
+    }
+  }
+
+  // Invokes visitor(x, y, z) for every cell of a grid of cells[0] * cells[1] * cells[2] cubes of cell_size, starting at origin,
+  // which is not fully outside of the frustum. The grid is tested as a hierarchy of cubic regions of 2^n cells: regions outside
+  // are rejected with a single test and regions fully inside emit all their cells without testing them, so the cost scales
+  // with the visible regions and not with the number of cells.
+  template<std::invocable<int, int, int> Visitor>
+  void visit_visible_cells(frustum const& frustum, rnu::vec3 origin, float cell_size, std::array<int, 3> cells, Visitor&& visitor)
+  {
+    int size = 1;
+    while (size < std::max({ cells[0], cells[1], cells[2] }))
+      size *= 2;
+    detail::visit_visible_cells(frustum, origin, cell_size, cells, { 0, 0, 0 }, size, false, visitor);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace goop
+{
+  // Caches a 2D field like a terrain heightmap in square tiles, so that everything stacked on the same
+  // (x, z) column shares one evaluation. Tiles are generated once on first request, concurrent requests
+  // for the same tile wait for that evaluation instead of repeating it.
+  template<typename T = float>
+  class heightmap_cache
+  {
+  public:
+    using tile_type = std::vector<T>;
+    // Fills the values of one tile, indexed as x + tile_size * z.
+    using generator_type = std::function<void(int tile_x, int tile_z, std::span<T> values)>;
+
+    heightmap_cache(std::size_t tile_size, generator_type generator)
+      : _tile_size(tile_size), _generator(std::move(generator))
+    {
+    }
+
+    std::shared_ptr<tile_type const> tile(int tile_x, int tile_z)
+    {
+      std::tuple index{ tile_x, tile_z };
+      std::promise<std::shared_ptr<tile_type const>> promise;
+      auto const result = promise.get_future().share();
+      {
+        std::unique_lock lock(_mtx);
+        auto const iter = _tiles.find(index);
+        if (iter != _tiles.end())
+        {
+          auto future = iter->second;
+          lock.unlock();
+          return future.get();
+        }
+        _tiles.emplace(index, result);
+      }
+
+      try
+      {
+        auto values = std::make_shared<tile_type>(_tile_size * _tile_size);
+        _generator(tile_x, tile_z, *values);
+        promise.set_value(std::move(values));
+      }
+      catch (...)
+      {
+        // Waiting requests see the failure, later ones try again.
+        promise.set_exception(std::current_exception());
+        erase(tile_x, tile_z);
+        throw;
+      }
+      return result.get();
+    }
+
+    void erase(int tile_x, int tile_z)
+    {
+      std::unique_lock lock(_mtx);
+      _tiles.erase(std::tuple{ tile_x, tile_z });
+    }
+
+    // Drops all tiles for which pred(tile_x, tile_z) returns true.
+    template<typename Pred>
+    void erase_if(Pred&& pred)
+    {
+      std::unique_lock lock(_mtx);
+      std::erase_if(_tiles, [&](auto const& entry) { return pred(std::get<0>(entry.first), std::get<1>(entry.first)); });
+    }
+
+    void clear()
+    {
+      std::unique_lock lock(_mtx);
+      _tiles.clear();
+    }
+
+    std::size_t tile_size() const
+    {
+      return _tile_size;
+    }
+
+    std::size_t tile_count() const
+    {
+      std::unique_lock lock(_mtx);
+      return _tiles.size();
+    }
+
+  private:
+    std::size_t _tile_size;
+    generator_type _generator;
+    mutable std::mutex _mtx;
+    std::map<std::tuple<int, int>, std::shared_future<std::shared_ptr<tile_type const>>> _tiles;
+  };
+}
@@ -2,32 +2,154 @@
 
 namespace goop {
 
+  namespace {
+    thread_local looper const* current_looper = nullptr;
+    thread_local std::size_t current_worker = 0;
+  }
+
   looper::looper(int concurrency) {
-    _threads.resize(concurrency);
+    _workers.resize(std::max(concurrency, 1));
+    for (auto& w : _workers)
+      w = std::make_unique<worker>();
+
+    _threads.resize(_workers.size());
+    for (std::size_t i = 0; i < _threads.size(); ++i)
+      _threads[i] = std::jthread(&looper::loop_fun, this, i);
+  }
+
+  looper::~looper()
+  {
+    // The workers have to be gone before the queues they work on.
     for (auto& t : _threads)
-      t = std::jthread(&looper::loop_fun, this);
+      t.request_stop();
+    _threads.clear();
   }
-  void looper::loop(std::stop_token stop_token)
+
+  void looper::schedule(task t, task_order order)
   {
-    while (!stop_token.stop_requested())
+    auto const index = current_looper == this ? current_worker : _next_worker.fetch_add(1) % _workers.size();
+    {
+      auto& w = *_workers[index];
+      std::unique_lock lock(w.mtx);
+      if (order == task_order::fifo)
+        w.fifo_tasks.push_back(std::move(t));
+      else
+        w.tasks.push_back(std::move(t));
+    }
+    _pending.fetch_add(1);
+
+    // A worker about to sleep has either registered itself already or still sees the new task.
+    if (_sleeping.load() != 0)
     {
       std::unique_lock lock(_mtx);
-      do {
-        _cnd.wait(lock, [&] { return stop_token.stop_requested() || !_runners.empty(); });
-      } while (!stop_token.stop_requested() && _runners.empty());
+      _cnd.notify_one();
+    }
+  }
+
+  void looper::defer(basic_task<bool> continuation)
+  {
+    {
+      std::unique_lock lock(_continuation_mtx);
+      _continuations.push_back(std::move(continuation));
+      _continuation_count.fetch_add(1);
+    }
+
+    if (_sleeping.load() != 0)
+    {
+      std::unique_lock lock(_mtx);
+      _cnd.notify_one();
+    }
+  }
 
-      if (stop_token.stop_requested())
-        return;
+  task looper::take(std::size_t index)
+  {
+    if (_pending.load() == 0)
+      return {};
+
+    {
+      auto& own = *_workers[index];
+      std::unique_lock lock(own.mtx);
+      if (!own.tasks.empty())
+      {
+        auto t = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        _pending.fetch_sub(1);
+        return t;
+      }
+      if (!own.fifo_tasks.empty())
+      {
+        auto t = std::move(own.fifo_tasks.front());
+        own.fifo_tasks.pop_front();
+        _pending.fetch_sub(1);
+        return t;
+      }
+    }
+
+    for (std::size_t offset = 1; offset < _workers.size(); ++offset)
+    {
+      auto& victim = *_workers[(index + offset) % _workers.size()];
+      std::unique_lock lock(victim.mtx, std::try_to_lock);
+      if (!lock.owns_lock())
+        continue;
+
+      // The oldest fifo task is the most urgent one, the oldest lifo task the one its owner would run last.
+      auto& queue = !victim.fifo_tasks.empty() ? victim.fifo_tasks : victim.tasks;
+      if (queue.empty())
+        continue;
+
+      auto t = std::move(queue.front());
+      queue.pop_front();
+      _pending.fetch_sub(1);
+      return t;
+    }
+    return {};
+  }
+
+  bool looper::poll_continuations()
+  {
+    if (_continuation_count.load() == 0)
+      return false;
+
+    std::unique_lock lock(_continuation_mtx, std::try_to_lock);
+    if (!lock.owns_lock())
+      return false;
+
+    auto const done = std::erase_if(_continuations, [](basic_task<bool>& c) { return c(); });
+    _continuation_count.fetch_sub(done);
+    return done != 0;
+  }
+
+  void looper::loop(std::stop_token stop_token, std::size_t index)
+  {
+    current_looper = this;
+    current_worker = index;
 
-      auto const runner = std::move(_runners.front());
-      _runners.pop();
-      lock.unlock();
-      runner();
+    while (!stop_token.stop_requested())
+    {
+      if (auto t = take(index))
+      {
+        t();
+        poll_continuations();
+        continue;
+      }
+
+      if (poll_continuations())
+        continue;
+
+      std::unique_lock lock(_mtx);
+      _sleeping.fetch_add(1);
+      auto const has_work = [&] { return _pending.load() != 0; };
+      // A continuation deferred while sleeping wakes the worker up, which then keeps polling it with the timed wait.
+      if (_continuation_count.load() == 0)
+        _cnd.wait(lock, stop_token, [&] { return has_work() || _continuation_count.load() != 0; });
+      else
+        _cnd.wait_for(lock, stop_token, std::chrono::milliseconds(1), has_work);
+      _sleeping.fetch_sub(1);
     }
   }
 
-  void looper::loop_fun(std::stop_token stop_token, looper* self) {
-    self->loop(stop_token);
+  void looper::loop_fun(std::stop_token stop_token, looper* self, std::size_t index) {
+    self->loop(stop_token, index);
   }
 
 }
\ No newline at end of file
@@ -3,9 +3,15 @@
 #include <thread>
 #include <future>
 #include <mutex>
+#include <condition_variable>
 #include <functional>
-#include <queue>
+#include <deque>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
 
 namespace goop
 {
@@ -15,53 +21,229 @@ namespace goop
     return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
   }
 
+  template<typename R>
+  bool is_ready(std::shared_future<R> const& f)
+  {
+    return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+
+  // Move-only R() callable. Callables of up to inline_size bytes are stored in place,
+  // so that scheduling small tasks does not allocate.
+  template<typename R>
+  class basic_task
+  {
+  public:
+    static constexpr std::size_t inline_size = 64;
+
+    basic_task() = default;
+
+    template<typename Fun> requires(!std::is_same_v<std::decay_t<Fun>, basic_task> && std::is_invocable_r_v<R, std::decay_t<Fun>&>)
+    basic_task(Fun&& fun)
+    {
+      using stored_type = std::decay_t<Fun>;
+      if constexpr (stored_inline<stored_type>)
+      {
+        new (_storage) stored_type(std::forward<Fun>(fun));
+        _vtable = &inline_vtable<stored_type>;
+      }
+      else
+      {
+        *reinterpret_cast<stored_type**>(_storage) = new stored_type(std::forward<Fun>(fun));
+        _vtable = &heap_vtable<stored_type>;
+      }
+    }
+
+    basic_task(basic_task&& other) noexcept
+      : _vtable(std::exchange(other._vtable, nullptr))
+    {
+      if (_vtable)
+        _vtable->move(_storage, other._storage);
+    }
+
+    basic_task& operator=(basic_task&& other) noexcept
+    {
+      if (this != &other)
+      {
+        reset();
+        _vtable = std::exchange(other._vtable, nullptr);
+        if (_vtable)
+          _vtable->move(_storage, other._storage);
+      }
+      return *this;
+    }
+
+    ~basic_task()
+    {
+      reset();
+    }
+
+    explicit operator bool() const
+    {
+      return _vtable != nullptr;
+    }
+
+    R operator()()
+    {
+      return _vtable->invoke(_storage);
+    }
+
+  private:
+    struct vtable
+    {
+      R(*invoke)(void* storage);
+      void(*move)(void* destination, void* source);
+      void(*destroy)(void* storage);
+    };
+
+    template<typename F>
+    static constexpr bool stored_inline = sizeof(F) <= inline_size && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+    template<typename F>
+    static constexpr vtable inline_vtable{
+      .invoke = [](void* storage) -> R { return (*static_cast<F*>(storage))(); },
+      .move = [](void* destination, void* source) {
+        new (destination) F(std::move(*static_cast<F*>(source)));
+        static_cast<F*>(source)->~F();
+      },
+      .destroy = [](void* storage) { static_cast<F*>(storage)->~F(); }
+    };
+
+    template<typename F>
+    static constexpr vtable heap_vtable{
+      .invoke = [](void* storage) -> R { return (**static_cast<F**>(storage))(); },
+      .move = [](void* destination, void* source) { *static_cast<F**>(destination) = *static_cast<F**>(source); },
+      .destroy = [](void* storage) { delete *static_cast<F**>(storage); }
+    };
+
+    void reset()
+    {
+      if (_vtable)
+        _vtable->destroy(_storage);
+      _vtable = nullptr;
+    }
+
+    alignas(std::max_align_t) std::byte _storage[inline_size];
+    vtable const* _vtable = nullptr;
+  };
+
+  using task = basic_task<void>;
+
+  // lifo tasks of a worker run newest first. fifo tasks are queued behind them and run in the order they were
+  // scheduled, for work that is submitted sorted by urgency. Thieves take the oldest fifo task before any lifo task.
+  enum class task_order
+  {
+    lifo,
+    fifo
+  };
+
+  // Work-stealing thread pool. Every worker owns a deque of tasks: it runs its own tasks newest first
+  // and steals the oldest ones of other workers when it runs dry. Tasks scheduled from outside the pool
+  // are distributed round-robin, tasks scheduled from a worker stay on that worker.
   class looper
   {
   public:
     looper(int concurrency = std::thread::hardware_concurrency());
+    ~looper();
+
+    looper(looper const&) = delete;
+    looper& operator=(looper const&) = delete;
 
     template<typename Fun>
-    std::future<std::invoke_result_t<Fun>> async(Fun&& fun)
+    std::future<std::invoke_result_t<Fun>> async(Fun&& fun, task_order order = task_order::lifo)
     {
       using result_type = std::invoke_result_t<Fun>;
-      auto promise = std::make_shared<std::promise<result_type>>();
-
-      {
-        std::unique_lock lock(_mtx);
-        _runners.push([promise, f = std::forward<Fun>(fun)]{
-          if constexpr (std::is_same_v<result_type, void>)
-          {
-            f();
-            promise->set_value();
-          }
-          else
-          {
-            promise->set_value(f());
-          }
-          });
-      }
-      _cnd.notify_one();
-      return promise->get_future();
+      std::promise<result_type> promise;
+      auto future = promise.get_future();
+      launch([promise = std::move(promise), f = std::forward<Fun>(fun)]() mutable {
+        fulfill(promise, f);
+        }, order);
+      return future;
     }
 
     template<typename Fun>
-    void launch(Fun&& fun)
+    void launch(Fun&& fun, task_order order = task_order::lifo)
     {
+      schedule(task(std::forward<Fun>(fun)), order);
+    }
+
+    // Runs fun(dependency.get()) once the dependency is ready. Waiting continuations are polled by
+    // otherwise idle workers, so no worker blocks on the dependency.
+    template<typename R, typename Fun>
+    auto then(std::shared_future<R> dependency, Fun&& fun)
+    {
+      auto call = [dependency, f = std::forward<Fun>(fun)]() mutable -> decltype(auto) {
+        if constexpr (std::is_same_v<R, void>)
+        {
+          dependency.get();
+          return f();
+        }
+        else
+        {
+          return f(dependency.get());
+        }
+      };
+
+      using result_type = std::invoke_result_t<decltype(call)&>;
+      std::promise<result_type> promise;
+      auto future = promise.get_future();
+      defer(basic_task<bool>([this, promise = std::move(promise), call = std::move(call), dependency = std::move(dependency)]() mutable {
+        if (!is_ready(dependency))
+          return false;
+
+        launch([promise = std::move(promise), call = std::move(call)]() mutable { fulfill(promise, call); });
+        return true;
+        }));
+      return future;
+    }
+
+  private:
+    struct worker
+    {
+      std::mutex mtx;
+      std::deque<task> tasks;
+      std::deque<task> fifo_tasks;
+    };
+
+    template<typename Result, typename Fun>
+    static void fulfill(std::promise<Result>& promise, Fun& fun)
+    {
+      try
+      {
+        if constexpr (std::is_same_v<Result, void>)
+        {
+          fun();
+          promise.set_value();
+        }
+        else
+        {
+          promise.set_value(fun());
+        }
+      }
+      catch (...)
       {
-        std::unique_lock lock(_mtx);
-        _runners.push([f = std::forward<Fun>(fun)]{ f(); });
+        promise.set_exception(std::current_exception());
       }
-      _cnd.notify_one();
     }
 
-  private:
-    void loop(std::stop_token stop_token);
+    void schedule(task t, task_order order);
+    void defer(basic_task<bool> continuation);
+    task take(std::size_t index);
+    bool poll_continuations();
+    void loop(std::stop_token stop_token, std::size_t index);
 
-    static void loop_fun(std::stop_token stop_token, looper* self);
+    static void loop_fun(std::stop_token stop_token, looper* self, std::size_t index);
 
-    std::vector<std::jthread> _threads;
-    std::condition_variable _cnd;
+    std::vector<std::unique_ptr<worker>> _workers;
+    std::atomic_size_t _pending = 0;
+    std::atomic_size_t _sleeping = 0;
+    std::atomic_size_t _next_worker = 0;
+
+    std::mutex _continuation_mtx;
+    std::vector<basic_task<bool>> _continuations;
+    std::atomic_size_t _continuation_count = 0;
+
+    std::condition_variable_any _cnd;
     std::mutex _mtx;
-    std::queue<std::function<void()>> _runners;
+    std::vector<std::jthread> _threads;
   };
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include <rnu/math/math.hpp>
+#include "perlin.hpp"
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GOOP_PERLIN_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GOOP_PERLIN_SSE2 1
+#endif
+
+namespace goop
+{
+  namespace
+  {
+#if GOOP_PERLIN_AVX2
+    struct lanes
+    {
+      static constexpr std::size_t width = 8;
+      using f = __m256;
+      using i = __m256i;
+
+      static f load(float const* p) { return _mm256_loadu_ps(p); }
+      static void store(float* p, f v) { _mm256_storeu_ps(p, v); }
+      static f set(float v) { return _mm256_set1_ps(v); }
+      static i set(int v) { return _mm256_set1_epi32(v); }
+      static f add(f a, f b) { return _mm256_add_ps(a, b); }
+      static f sub(f a, f b) { return _mm256_sub_ps(a, b); }
+      static f mul(f a, f b) { return _mm256_mul_ps(a, b); }
+      static f div(f a, f b) { return _mm256_div_ps(a, b); }
+      static f negate(f a) { return _mm256_xor_ps(a, set(-0.0f)); }
+      static f less(f a, f b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+      static f select(f mask, f a, f b) { return _mm256_blendv_ps(b, a, mask); }
+      static f select(i mask, f a, f b) { return select(_mm256_castsi256_ps(mask), a, b); }
+      static i add(i a, i b) { return _mm256_add_epi32(a, b); }
+      static i bit_and(i a, i b) { return _mm256_and_si256(a, b); }
+      static i bit_or(i a, i b) { return _mm256_or_si256(a, b); }
+      static i less(i a, i b) { return _mm256_cmpgt_epi32(b, a); }
+      static i equal(i a, i b) { return _mm256_cmpeq_epi32(a, b); }
+      static i truncate(f a) { return _mm256_cvttps_epi32(a); }
+      static f to_float(i a) { return _mm256_cvtepi32_ps(a); }
+      static i gather(int const* table, i index) { return _mm256_i32gather_epi32(table, index, 4); }
+    };
+#elif GOOP_PERLIN_SSE2
+    struct lanes
+    {
+      static constexpr std::size_t width = 4;
+      using f = __m128;
+      using i = __m128i;
+
+      static f load(float const* p) { return _mm_loadu_ps(p); }
+      static void store(float* p, f v) { _mm_storeu_ps(p, v); }
+      static f set(float v) { return _mm_set1_ps(v); }
+      static i set(int v) { return _mm_set1_epi32(v); }
+      static f add(f a, f b) { return _mm_add_ps(a, b); }
+      static f sub(f a, f b) { return _mm_sub_ps(a, b); }
+      static f mul(f a, f b) { return _mm_mul_ps(a, b); }
+      static f div(f a, f b) { return _mm_div_ps(a, b); }
+      static f negate(f a) { return _mm_xor_ps(a, set(-0.0f)); }
+      static f less(f a, f b) { return _mm_cmplt_ps(a, b); }
+      static f select(f mask, f a, f b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+      static f select(i mask, f a, f b) { return select(_mm_castsi128_ps(mask), a, b); }
+      static i add(i a, i b) { return _mm_add_epi32(a, b); }
+      static i bit_and(i a, i b) { return _mm_and_si128(a, b); }
+      static i bit_or(i a, i b) { return _mm_or_si128(a, b); }
+      static i less(i a, i b) { return _mm_cmplt_epi32(a, b); }
+      static i equal(i a, i b) { return _mm_cmpeq_epi32(a, b); }
+      static i truncate(f a) { return _mm_cvttps_epi32(a); }
+      static f to_float(i a) { return _mm_cvtepi32_ps(a); }
+      static i gather(int const* table, i index)
+      {
+        alignas(16) int indices[width];
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+        return _mm_setr_epi32(table[indices[0]], table[indices[1]], table[indices[2]], table[indices[3]]);
+      }
+    };
+#endif
+
+#if GOOP_PERLIN_AVX2 || GOOP_PERLIN_SSE2
+    // Every operation mirrors the scalar perlin_noise in the same order, so that each lane rounds exactly like it.
+    lanes::f fade(lanes::f t)
+    {
+      using L = lanes;
+      return L::mul(L::mul(L::mul(t, t), t), L::add(L::mul(t, L::sub(L::mul(t, L::set(6.0f)), L::set(15.0f))), L::set(10.0f)));
+    }
+
+    lanes::f fract(lanes::f v)
+    {
+      using L = lanes;
+      auto const val = L::sub(v, L::to_float(L::truncate(v)));
+      return L::select(L::less(val, L::set(0.0f)), L::negate(val), val);
+    }
+
+    lanes::f grad(lanes::i hash, lanes::f x, lanes::f y, lanes::f z)
+    {
+      using L = lanes;
+      auto const h = L::bit_and(hash, L::set(0xF));
+      auto const u = L::select(L::less(h, L::set(8)), x, y);
+      auto const v = L::select(L::less(h, L::set(4)), y,
+        L::select(L::bit_or(L::equal(h, L::set(0xC)), L::equal(h, L::set(0xE))), x, z));
+
+      auto const negate_u = L::equal(L::bit_and(h, L::set(1)), L::set(1));
+      auto const negate_v = L::equal(L::bit_and(h, L::set(2)), L::set(2));
+      return L::add(L::select(negate_u, L::negate(u), u), L::select(negate_v, L::negate(v), v));
+    }
+
+    lanes::f lerp(lanes::f a, lanes::f b, lanes::f t)
+    {
+      using L = lanes;
+      return L::add(a, L::mul(t, L::sub(b, a)));
+    }
+
+    lanes::f perlin_noise(lanes::f x, lanes::f y, lanes::f z)
+    {
+      using L = lanes;
+      x = L::add(x, L::set(1000.0f));
+      y = L::add(y, L::set(1000.0f));
+      z = L::add(z, L::set(1000.0f));
+
+      auto const byte_mask = L::set(0xFF);
+      auto const one = L::set(1);
+      auto const xi = L::bit_and(L::truncate(x), byte_mask);
+      auto const yi = L::bit_and(L::truncate(y), byte_mask);
+      auto const zi = L::bit_and(L::truncate(z), byte_mask);
+
+      auto const xf = fract(x);
+      auto const yf = fract(y);
+      auto const zf = fract(z);
+
+      auto const u = fade(xf);
+      auto const v = fade(yf);
+      auto const w = fade(zf);
+
+      int const* p = permutation_doubled.data();
+      auto const a = L::gather(p, xi);
+      auto const b = L::gather(p, L::add(xi, one));
+      auto const aa = L::gather(p, L::add(a, yi));
+      auto const ab = L::gather(p, L::add(L::add(a, yi), one));
+      auto const ba = L::gather(p, L::add(b, yi));
+      auto const bb = L::gather(p, L::add(L::add(b, yi), one));
+      auto const aaa = L::gather(p, L::add(aa, zi));
+      auto const aab = L::gather(p, L::add(L::add(aa, zi), one));
+      auto const aba = L::gather(p, L::add(ab, zi));
+      auto const abb = L::gather(p, L::add(L::add(ab, zi), one));
+      auto const baa = L::gather(p, L::add(ba, zi));
+      auto const bab = L::gather(p, L::add(L::add(ba, zi), one));
+      auto const bba = L::gather(p, L::add(bb, zi));
+      auto const bbb = L::gather(p, L::add(L::add(bb, zi), one));
+
+      auto const xf1 = L::sub(xf, L::set(1.0f));
+      auto const yf1 = L::sub(yf, L::set(1.0f));
+      auto const zf1 = L::sub(zf, L::set(1.0f));
+
+      auto x1 = lerp(grad(aaa, xf, yf, zf), grad(baa, xf1, yf, zf), u);
+      auto x2 = lerp(grad(aba, xf, yf1, zf), grad(bba, xf1, yf1, zf), u);
+      auto const y1 = lerp(x1, x2, v);
+      x1 = lerp(grad(aab, xf, yf, zf1), grad(bab, xf1, yf, zf1), u);
+      x2 = lerp(grad(abb, xf, yf1, zf1), grad(bbb, xf1, yf1, zf1), u);
+      auto const y2 = lerp(x1, x2, v);
+
+      return L::div(L::add(lerp(y1, y2, w), L::set(1.0f)), L::set(2.0f));
+    }
+#endif
+  }
+
+  void perlin_noise(std::span<float const> x, std::span<float const> y, std::span<float const> z, std::span<float> out, int octaves, float persistence)
+  {
+    if (x.size() < out.size() || y.size() < out.size() || z.size() < out.size())
+      throw std::invalid_argument("Sample coordinates must cover all output values.");
+
+    std::size_t i = 0;
+
+#if GOOP_PERLIN_AVX2 || GOOP_PERLIN_SSE2
+    using L = lanes;
+    for (; i + L::width <= out.size(); i += L::width)
+    {
+      auto const px = L::load(&x[i]);
+      auto const py = L::load(&y[i]);
+      auto const pz = L::load(&z[i]);
+
+      auto val = L::set(0.0f);
+      float frequency = 1;
+      float amplitude = 1;
+      float maxValue = 0;
+      for (int octave = 0; octave < octaves; ++octave)
+      {
+        auto const f = L::set(frequency);
+        val = L::add(val, L::mul(perlin_noise(L::mul(f, px), L::mul(f, py), L::mul(f, pz)), L::set(amplitude)));
+
+        maxValue += amplitude;
+        amplitude *= persistence;
+        frequency *= 2;
+      }
+      L::store(&out[i], L::div(val, L::set(maxValue)));
+    }
+#endif
+
+    for (; i < out.size(); ++i)
+      out[i] = perlin_noise(x[i], y[i], z[i], octaves, persistence);
+  }
+}
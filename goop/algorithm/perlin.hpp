@@ -2,6 +2,8 @@
 
 #include <array>
 #include <algorithm>
+#include <span>
+#include <rnu/math/math.hpp>
 
 namespace goop
 {
@@ -145,4 +147,8 @@ namespace goop
     }
     return val / maxValue;
   }
+
+  // Evaluates out[i] = perlin_noise(x[i], y[i], z[i], octaves, persistence) for structure-of-arrays sample points.
+  // Uses AVX2 or SSE2 lanes if the target supports them, with results bit-identical to the scalar version.
+  void perlin_noise(std::span<float const> x, std::span<float const> y, std::span<float const> z, std::span<float> out, int octaves = 1, float persistence = 0.5f);
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "range_allocator.hpp"
+#include <stdexcept>
+
+namespace goop
+{
+  float range_allocator::statistics::fragmentation() const
+  {
+    if (free == 0)
+      return 0.f;
+    return 1.f - float(largest_free_range) / float(free);
+  }
+
+  std::size_t range_allocator::allocate(std::size_t count)
+  {
+    if (count == 0)
+      return _size;
+
+    std::size_t offset = _size;
+    if (auto const best = _free_by_count.lower_bound(count); best != _free_by_count.end())
+    {
+      offset = best->second;
+      auto const available = best->first;
+      erase_free(_free.find(offset));
+      if (available > count)
+        insert_free(offset + count, available - count);
+    }
+    else
+    {
+      _size += count;
+    }
+
+    _allocated.emplace(offset, count);
+    return offset;
+  }
+
+  void range_allocator::release(std::size_t offset)
+  {
+    auto const it = _allocated.find(offset);
+    if (it == _allocated.end())
+      throw std::invalid_argument("No range is allocated at the given offset.");
+
+    auto count = it->second;
+    _allocated.erase(it);
+
+    if (auto const next = _free.find(offset + count); next != _free.end())
+    {
+      count += next->second;
+      erase_free(next);
+    }
+    if (auto const next = _free.lower_bound(offset); next != _free.begin())
+    {
+      auto const previous = std::prev(next);
+      if (previous->first + previous->second == offset)
+      {
+        offset = previous->first;
+        count += previous->second;
+        erase_free(previous);
+      }
+    }
+
+    if (offset + count == _size)
+      _size = offset;
+    else
+      insert_free(offset, count);
+  }
+
+  std::size_t range_allocator::count_at(std::size_t offset) const
+  {
+    auto const it = _allocated.find(offset);
+    return it == _allocated.end() ? 0 : it->second;
+  }
+
+  void range_allocator::clear()
+  {
+    _size = 0;
+    _allocated.clear();
+    _free.clear();
+    _free_by_count.clear();
+  }
+
+  std::vector<range_allocator::relocation> range_allocator::compact()
+  {
+    std::vector<relocation> relocations;
+    std::map<std::size_t, std::size_t> allocated;
+    std::size_t cursor = 0;
+    for (auto const& [offset, count] : _allocated)
+    {
+      if (offset != cursor)
+        relocations.push_back(relocation{ .from = offset, .to = cursor, .count = count });
+      allocated.emplace_hint(allocated.end(), cursor, count);
+      cursor += count;
+    }
+
+    _allocated = std::move(allocated);
+    _free.clear();
+    _free_by_count.clear();
+    _size = cursor;
+    return relocations;
+  }
+
+  std::size_t range_allocator::size() const
+  {
+    return _size;
+  }
+
+  range_allocator::statistics range_allocator::stats() const
+  {
+    statistics result{ .size = _size, .used = 0, .free = 0, .free_ranges = _free.size(), .largest_free_range = 0 };
+    for (auto const& [offset, count] : _allocated)
+      result.used += count;
+    result.free = _size - result.used;
+    if (!_free_by_count.empty())
+      result.largest_free_range = std::prev(_free_by_count.end())->first;
+    return result;
+  }
+
+  void range_allocator::insert_free(std::size_t offset, std::size_t count)
+  {
+    _free.emplace(offset, count);
+    _free_by_count.emplace(count, offset);
+  }
+
+  void range_allocator::erase_free(std::map<std::size_t, std::size_t>::iterator it)
+  {
+    auto [first, last] = _free_by_count.equal_range(it->second);
+    while (first->second != it->first)
+      ++first;
+    _free_by_count.erase(first);
+    _free.erase(it);
+  }
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace goop
+{
+  // Best-fit free-list allocator for ranges of elements in an arena which grows at its end on demand.
+  // Released ranges are merged with their free neighbors, a free range at the end shrinks the arena.
+  class range_allocator
+  {
+  public:
+    struct statistics
+    {
+      std::size_t size;
+      std::size_t used;
+      std::size_t free;
+      std::size_t free_ranges;
+      std::size_t largest_free_range;
+
+      // 0 if all free elements are contiguous, approaching 1 the more they are scattered into small ranges.
+      float fragmentation() const;
+    };
+
+    struct relocation
+    {
+      std::size_t from;
+      std::size_t to;
+      std::size_t count;
+    };
+
+    // Returns the offset of count free elements. Empty allocations are not tracked and need no release.
+    std::size_t allocate(std::size_t count);
+    void release(std::size_t offset);
+    std::size_t count_at(std::size_t offset) const;
+    void clear();
+
+    // Moves all allocations to the front of the arena in their current order, so that no free ranges remain.
+    // The returned relocations are sorted by ascending offset and never overlap a relocation which comes after them.
+    std::vector<relocation> compact();
+
+    std::size_t size() const;
+    statistics stats() const;
+
+  private:
+    void insert_free(std::size_t offset, std::size_t count);
+    void erase_free(std::map<std::size_t, std::size_t>::iterator it);
+
+    std::size_t _size = 0;
+    std::map<std::size_t, std::size_t> _allocated;
+    std::map<std::size_t, std::size_t> _free;
+    std::multimap<std::size_t, std::size_t> _free_by_count;
+  };
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "ring_allocator.hpp"
+#include <stdexcept>
+
+namespace goop
+{
+  ring_allocator::ring_allocator(std::size_t capacity)
+    : _capacity(capacity)
+  {
+    if (capacity == 0)
+      throw std::invalid_argument("Ring allocator capacity must not be zero.");
+  }
+
+  std::optional<std::size_t> ring_allocator::allocate(std::size_t size, std::size_t alignment)
+  {
+    if (alignment == 0 || _capacity % alignment != 0)
+      throw std::invalid_argument("Alignment must divide the ring allocator capacity.");
+    if (size > _capacity)
+      throw std::invalid_argument("Allocation is larger than the ring allocator capacity.");
+
+    auto position = (_head + alignment - 1) / alignment * alignment;
+    if (position % _capacity + size > _capacity)
+      position = (position / _capacity + 1) * _capacity;
+
+    if (position + size - _tail > _capacity)
+      return std::nullopt;
+
+    _head = position + size;
+    return static_cast<std::size_t>(position % _capacity);
+  }
+
+  std::uint64_t ring_allocator::end_frame()
+  {
+    auto const id = _next_frame++;
+    _frames.push_back(frame{ .id = id, .end = _head });
+    return id;
+  }
+
+  void ring_allocator::retire(std::uint64_t frame)
+  {
+    while (!_frames.empty() && _frames.front().id <= frame)
+    {
+      _tail = _frames.front().end;
+      _frames.pop_front();
+    }
+  }
+
+  std::optional<std::uint64_t> ring_allocator::oldest_pending_frame() const
+  {
+    if (_frames.empty())
+      return std::nullopt;
+    return _frames.front().id;
+  }
+
+  std::size_t ring_allocator::pending_frames() const
+  {
+    return _frames.size();
+  }
+
+  std::size_t ring_allocator::capacity() const
+  {
+    return _capacity;
+  }
+
+  std::size_t ring_allocator::used() const
+  {
+    return static_cast<std::size_t>(_head - _tail);
+  }
+}
\ No newline at end of file
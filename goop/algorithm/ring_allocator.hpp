@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace goop
+{
+  // Backend independent bookkeeping of a ring of memory that is sub-allocated linearly and reclaimed a whole frame at a time.
+  // Positions grow monotonically, the physical offset of a position is position % capacity.
+  class ring_allocator
+  {
+  public:
+    // Alignments passed to allocate have to divide the capacity.
+    ring_allocator(std::size_t capacity);
+
+    // Returns the offset of size free bytes aligned to alignment, or nothing if the ring is occupied by frames which are not retired yet.
+    // An allocation never wraps around the end of the ring.
+    std::optional<std::size_t> allocate(std::size_t size, std::size_t alignment);
+
+    // Closes the current frame, everything allocated since the previous call belongs to it.
+    std::uint64_t end_frame();
+    // Makes the memory of all frames up to and including the given one available again.
+    void retire(std::uint64_t frame);
+
+    std::optional<std::uint64_t> oldest_pending_frame() const;
+    std::size_t pending_frames() const;
+    std::size_t capacity() const;
+    std::size_t used() const;
+
+  private:
+    struct frame
+    {
+      std::uint64_t id;
+      std::uint64_t end;
+    };
+
+    std::size_t _capacity;
+    std::uint64_t _head = 0;
+    std::uint64_t _tail = 0;
+    std::uint64_t _next_frame = 0;
+    std::deque<frame> _frames;
+  };
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "chunk_neighborhood.hpp"
+
+namespace goop
+{
+  std::size_t chunk_border::border_size() const
+  {
+    return _dimension;
+  }
+
+  bool chunk_border::is_opaque(voxel_face side, int u, int v) const
+  {
+    return (_slabs[static_cast<std::size_t>(side)][u] >> v) & 1;
+  }
+
+  chunk_neighborhood::chunk_neighborhood(std::size_t dimension, std::array<chunk_border const*, 6> neighbors)
+    : _dimension(dimension), _neighbors(neighbors)
+  {
+  }
+
+  bool chunk_neighborhood::operator()(int x, int y, int z) const
+  {
+    std::array const p{ x, y, z };
+    int const dim = static_cast<int>(_dimension);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      if (p[axis] >= 0 && p[axis] < dim)
+        continue;
+
+      // The neighbor in positive direction touches this chunk with its negative side and vice versa.
+      bool const positive = p[axis] >= dim;
+      auto const* neighbor = _neighbors[axis * 2 + (positive ? 0 : 1)];
+      if (!neighbor)
+        return false;
+
+      auto const side = static_cast<voxel_face>(axis * 2 + (positive ? 1 : 0));
+      return neighbor->is_opaque(side, p[(axis + 1) % 3], p[(axis + 2) % 3]);
+    }
+    return false;
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "dynamic_octree.hpp"
+#include "voxel_vertex.hpp"
+
+namespace goop
+{
+  // Opacity of the outermost layer of blocks on each side of a chunk, one bit per block.
+  // Slabs are indexed by voxel_face, with the in-plane axes ordered like in the greedy mesher (x: y, z | y: z, x | z: x, y).
+  class chunk_border
+  {
+  public:
+    static constexpr std::size_t max_dimension = 62;
+
+    chunk_border() = default;
+    template<std::size_t Exp>
+    explicit chunk_border(dynamic_octree<std::uint16_t, Exp> const& chunk);
+
+    std::size_t border_size() const;
+    bool is_opaque(voxel_face side, int u, int v) const;
+
+  private:
+    std::size_t _dimension = 0;
+    std::array<std::vector<std::uint64_t>, 6> _slabs;
+  };
+
+  // Answers the opacity of the blocks around a chunk from the cached borders of its neighbors,
+  // without evaluating any terrain function again. Neighbors are indexed by the voxel_face they are adjacent to.
+  class chunk_neighborhood
+  {
+  public:
+    chunk_neighborhood(std::size_t dimension, std::array<chunk_border const*, 6> neighbors);
+
+    // Only valid for the one block thick shell around the chunk, where one of the coordinates is -1 or border_size().
+    // Missing neighbors are treated as empty.
+    bool operator()(int x, int y, int z) const;
+
+  private:
+    std::size_t _dimension;
+    std::array<chunk_border const*, 6> _neighbors;
+  };
+
+  template<std::size_t Exp>
+  chunk_border::chunk_border(dynamic_octree<std::uint16_t, Exp> const& chunk)
+    : _dimension(chunk.border_size())
+  {
+    if (_dimension > max_dimension)
+      throw std::invalid_argument("Chunk dimension exceeds the supported maximum of chunk borders.");
+
+    for (auto& slab : _slabs)
+      slab.assign(_dimension, 0);
+
+    int const dim = static_cast<int>(_dimension);
+    chunk.visit_leaves([&](auto const& leaf) {
+      if (leaf.value == 0)
+        return;
+
+      std::array<int, 3> const base{ int(leaf.base_x), int(leaf.base_y), int(leaf.base_z) };
+      int const size = int(leaf.size);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        for (int side = 0; side < 2; ++side)
+        {
+          int const layer = side == 0 ? dim - 1 : 0;
+          if (layer < base[axis] || layer >= base[axis] + size)
+            continue;
+
+          int const u = base[(axis + 1) % 3];
+          std::uint64_t const bits = ((std::uint64_t(1) << size) - 1) << base[(axis + 2) % 3];
+          for (int row = u; row < u + size; ++row)
+            _slabs[axis * 2 + side][row] |= bits;
+        }
+      }
+      });
+  }
+}
@@ -68,8 +68,13 @@ namespace goop
     _texture_provider.free(_draw_textures.color);
     _texture_provider.free(_draw_textures.depth_stencil);
 
-    auto const img = _draw_state->display(_default_render_target, window_width, window_height);
+    auto const img = [&] {
+      GOOP_PROFILE_ZONE("default_app::display");
+      return _draw_state->display(_default_render_target, window_width, window_height);
+    }();
     glfwPollEvents();
+
+    _last_frame_profile = profiler::instance().end_frame();
     return img;
 	}
 
@@ -108,6 +113,10 @@ namespace goop
   {
     return _current_delta_time;
   }
+  frame_profile const& default_app::last_frame_profile() const
+  {
+    return _last_frame_profile;
+  }
   default_app::window_ptr const& default_app::window() const {
     return _window;
   }
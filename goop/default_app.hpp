@@ -6,6 +6,7 @@
 #include <rnu/camera.hpp>
 #include <graphics.hpp>
 #include <animation/smooth.hpp>
+#include <profiler.hpp>
 #include <chrono>
 
 namespace goop
@@ -61,6 +62,8 @@ namespace goop
 		int end_frame();
 
 		std::chrono::duration<double> current_delta_time() const;
+		// Zones recorded during the previous frame, see goop::profiler.
+		frame_profile const& last_frame_profile() const;
 		window_ptr const& window() const;
 		draw_state & default_draw_state() ;
 		rnu::cameraf const& default_camera() const;
@@ -87,6 +90,7 @@ namespace goop
 
 		std::chrono::steady_clock::time_point _last_frame_time;
 		std::chrono::duration<double> _current_delta_time;
+		frame_profile _last_frame_profile;
 		window_ptr _window;
 		draw_state _draw_state;
 		rnu::cameraf _default_camera;
@@ -0,0 +1,24 @@
+#include "draw_compaction.hpp"
+#include <stdexcept>
+
+namespace goop
+{
+  std::uint32_t compact_draws(frustum const& frustum, std::span<culled_draw const> draws, std::span<draw_info_indexed> visible_commands)
+  {
+    if (visible_commands.size() < draws.size())
+      throw std::invalid_argument("The visible command span must be able to hold all draws.");
+
+    std::uint32_t count = 0;
+    for (auto const& draw : draws)
+    {
+      if (draw.command.instance_count == 0)
+        continue;
+
+      rnu::vec3 const min(draw.bounds_min.x, draw.bounds_min.y, draw.bounds_min.z);
+      rnu::vec3 const max(draw.bounds_max.x, draw.bounds_max.y, draw.bounds_max.z);
+      if (cull_aabb(frustum, min, max) != cull_result::fully_outside)
+        visible_commands[count++] = draw.command;
+    }
+    return count;
+  }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <rnu/math/math.hpp>
+#include "generic/geometry_format.hpp"
+#include "algorithm/cull.hpp"
+
+namespace goop
+{
+  // An indexed draw command together with the world space bounds of what it draws.
+  // The layout matches the std430 struct read by the compaction pass of multi_draw_base::draw_culled.
+  struct culled_draw
+  {
+    draw_info_indexed command;
+    std::uint32_t padding[3];
+    rnu::vec4 bounds_min;
+    rnu::vec4 bounds_max;
+  };
+
+  static_assert(sizeof(culled_draw) == 64, "culled_draw must match the layout of the compaction shader.");
+
+  // CPU reference of the GPU compaction pass. Writes the commands of all draws with a non-zero instance count whose
+  // bounds are not fully outside of the frustum to visible_commands and returns how many were written.
+  // The commands keep their relative order here, the GPU pass writes the same set in an unspecified order.
+  std::uint32_t compact_draws(frustum const& frustum, std::span<culled_draw const> draws, std::span<draw_info_indexed> visible_commands);
+}
@@ -4,6 +4,10 @@
 #include <optional>
 #include <type_traits>
 #include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <concepts>
+#include <span>
 
 namespace goop
 {
@@ -18,50 +22,45 @@ namespace goop
       return 2 * exp2(val - 1);
     }
 
-    template<typename Data, std::size_t Exp>
-    struct octree_data_holder
+    template<std::size_t Exp>
+    struct octree_extent
     {
-      struct node
-      {
-        std::optional<Data> value;
-      };
-
       static constexpr auto exponent = Exp;
       static constexpr auto dimension = detail::exp2(exponent);
-      static constexpr auto num_nodes = exponent * dimension * dimension * dimension;
-      static constexpr auto required_memory = sizeof(node) * num_nodes;
-
-      std::array<node, num_nodes> _nodes;
     };
 
-    template<typename Data>
-    struct octree_data_holder<Data, runtime_exponent>
+    template<>
+    struct octree_extent<runtime_exponent>
     {
-      struct node
-      {
-        std::optional<Data> value;
-      };
-
-      constexpr octree_data_holder<Data, runtime_exponent>(std::size_t exponent);
+      constexpr octree_extent(std::size_t exponent)
+        : exponent(exponent), dimension(detail::exp2(exponent)) {}
 
       std::size_t exponent;
       std::size_t dimension;
-      std::size_t num_nodes;
-      std::size_t required_memory;
-      std::vector<node> _nodes;
     };
   }
 
   template<typename T>
   concept octree_value_type = std::is_fundamental_v<T>;
 
+  template<typename G, typename Data>
+  concept octree_generator = std::is_invocable_r_v<Data, G&, int, int, int>;
+
   template<octree_value_type Data, std::size_t Exp = runtime_exponent>
-  class dynamic_octree : protected detail::octree_data_holder<Data, Exp>
+  class dynamic_octree : protected detail::octree_extent<Exp>
   {
 
   public:
     using value_type = Data;
-    using node = typename detail::octree_data_holder<Data, Exp>::node;
+
+    // Nodes are stored in one flat pool. A subdivided node refers to its 8 children by the offset
+    // of the first one, the children are always stored consecutively. Only subdivided regions
+    // allocate nodes, so the memory footprint scales with the surface and not with the volume.
+    struct node
+    {
+      std::uint32_t children = 0;
+      Data value{};
+    };
 
     struct dimension_value
     {
@@ -79,20 +78,38 @@ namespace goop
     constexpr Data at(int x, int y, int z) const;
     constexpr void emplace(int x, int y, int z, Data t);
 
+    // Rebuilds the whole tree bottom-up in a single pass. The generator is invoked exactly once per
+    // voxel as generator(x, y, z), in Morton order.
+    template<octree_generator<Data> Generator>
+    constexpr void fill(Generator&& generator);
+    // Dense voxels are indexed as x + dimension * (y + dimension * z).
+    constexpr void fill(std::span<Data const> voxels);
+    constexpr void extract(std::span<Data> voxels) const;
+
+    // Invokes visitor(dimension_value) once for every uniform leaf region, in Z-order.
+    template<std::invocable<dimension_value const&> Visitor>
+    constexpr void visit_leaves(Visitor&& visitor) const;
+
     constexpr std::size_t border_size() const;
+    constexpr std::size_t node_count() const;
+    constexpr std::size_t memory_usage() const;
 
   private:
-    constexpr std::ptrdiff_t children_start_index(std::ptrdiff_t index) const;
-    constexpr std::ptrdiff_t parent_index(std::ptrdiff_t index) const;
-    constexpr std::ptrdiff_t next(int x, int y, int z, int half_dim, std::ptrdiff_t src) const;
+    static constexpr std::uint32_t octant(int x, int y, int z, int half_dim);
+
+    constexpr std::uint32_t allocate_children(Data value);
+    constexpr void release_children(std::uint32_t offset);
 
-    constexpr std::span<node const> child_nodes(std::ptrdiff_t index) const;
+    template<typename Generator>
+    constexpr void build(std::uint32_t index, int x, int y, int z, int size, Generator& generator);
+    template<typename Visitor>
+    constexpr void for_each_leaf(std::uint32_t index, int x, int y, int z, int size, Visitor& visitor) const;
 
-    constexpr void merge(std::ptrdiff_t index, std::optional<Data> with_value);
-    constexpr void divide(std::ptrdiff_t index);
+    using detail::octree_extent<Exp>::exponent;
+    using detail::octree_extent<Exp>::dimension;
 
-    using detail::octree_data_holder<Data, Exp>::_nodes;
-    using detail::octree_data_holder<Data, Exp>::dimension;
+    std::vector<node> _nodes;
+    std::vector<std::uint32_t> _free_blocks;
   };
 }
 
@@ -1,63 +1,44 @@
 #include "dynamic_octree.hpp"
 namespace goop
 {
-  template<typename Data>
-  constexpr detail::octree_data_holder<Data, runtime_exponent>::octree_data_holder(std::size_t exponent)
-  {
-    this->exponent = exponent;
-    this->dimension = detail::exp2(exponent);
-    this->num_nodes = exponent * dimension * dimension * dimension;
-    this->required_memory = sizeof(node) * num_nodes;
-    _nodes.resize(this->num_nodes);
-  }
-
   template<octree_value_type Data, std::size_t Exp>
   constexpr dynamic_octree<Data, Exp>::dynamic_octree() requires(Exp != runtime_exponent)
+    : _nodes(1)
   {
-    _nodes[0].value = Data{};
   }
 
   template<octree_value_type Data, std::size_t Exp>
   constexpr dynamic_octree<Data, Exp>::dynamic_octree(std::size_t exponent) requires(Exp == runtime_exponent)
-    : detail::octree_data_holder<Data, runtime_exponent>::octree_data_holder(exponent)
+    : detail::octree_extent<runtime_exponent>::octree_extent(exponent), _nodes(1)
   {
-    _nodes[0].value = Data{};
   }
 
   template<octree_value_type Data, std::size_t Exp>
   constexpr typename dynamic_octree<Data, Exp>::dimension_value dynamic_octree<Data, Exp>::info(int x, int y, int z) const
   {
-    std::ptrdiff_t node_index = 0;
-    int half_dim = dimension;
+    std::uint32_t node_index = 0;
+    int size = static_cast<int>(dimension);
 
     int pos_x = 0;
     int pos_y = 0;
     int pos_z = 0;
-    int depth = 0;
 
-    while (!_nodes[node_index].value)
+    while (_nodes[node_index].children != 0)
     {
-      auto const next_index = next(x, y, z, half_dim /= 2, node_index);
-      if (next_index >= _nodes.size())
-        break;
-      node_index = next_index;
-
-      x %= half_dim;
-      y %= half_dim;
-      z %= half_dim;
-
-      pos_x += (x >= half_dim) ? half_dim : 0;
-      pos_y += (y >= half_dim) ? half_dim : 0;
-      pos_z += (z >= half_dim) ? half_dim : 0;
-      ++depth;
+      size /= 2;
+      node_index = _nodes[node_index].children + octant(x, y, z, size);
+
+      if (x >= size) { x -= size; pos_x += size; }
+      if (y >= size) { y -= size; pos_y += size; }
+      if (z >= size) { z -= size; pos_z += size; }
     }
 
     return dimension_value{
       .base_x = static_cast<std::size_t>(pos_x),
       .base_y = static_cast<std::size_t>(pos_y),
       .base_z = static_cast<std::size_t>(pos_z),
-      .size = dimension / static_cast<int>(std::exp2(depth)),
-      .value = *_nodes[node_index].value
+      .size = static_cast<std::size_t>(size),
+      .value = _nodes[node_index].value
     };
   }
 
@@ -76,41 +57,88 @@ namespace goop
     if (x >= dimension || x < 0 || y >= dimension || y < 0 || z >= dimension || z < 0)
       return;
 
-    std::ptrdiff_t node_index = 0;
-    int half_dim = dimension;
+    // Remember the way down to be able to merge uniform children back up afterwards.
+    std::array<std::uint32_t, 8 * sizeof(int)> path{};
+    std::size_t depth = 0;
 
-    while (node_index < _nodes.size())
+    std::uint32_t node_index = 0;
+    int size = static_cast<int>(dimension);
+
+    while (true)
     {
-      while (!_nodes[node_index].value)
+      if (_nodes[node_index].children == 0)
       {
-        auto const next_index = next(x, y, z, half_dim /= 2, node_index);
-        if (next_index >= _nodes.size())
+        if (_nodes[node_index].value == t)
+          return;
+        if (size == 1)
           break;
-        node_index = next_index;
-        x %= half_dim;
-        y %= half_dim;
-        z %= half_dim;
+
+        auto const children = allocate_children(_nodes[node_index].value);
+        _nodes[node_index].children = children;
       }
-      if (_nodes[node_index].value == t)
+
+      path[depth++] = node_index;
+      size /= 2;
+      node_index = _nodes[node_index].children + octant(x, y, z, size);
+      x %= size;
+      y %= size;
+      z %= size;
+    }
+
+    _nodes[node_index].value = t;
+
+    while (depth > 0)
+    {
+      auto const parent = path[--depth];
+      auto const children = _nodes[parent].children;
+      auto const begin = std::next(_nodes.begin(), children);
+      if (!std::all_of(begin, std::next(begin, 8), [&](node const& n) { return n.children == 0 && n.value == t; }))
         return;
-      else if (!_nodes[node_index].value || children_start_index(node_index) >= _nodes.size())
+
+      release_children(children);
+      _nodes[parent] = node{ .children = 0, .value = t };
+    }
+  }
+
+  template<octree_value_type Data, std::size_t Exp>
+  template<octree_generator<Data> Generator>
+  constexpr void dynamic_octree<Data, Exp>::fill(Generator&& generator)
+  {
+    _nodes.assign(1, node{});
+    _free_blocks.clear();
+    build(0, 0, 0, 0, static_cast<int>(dimension), generator);
+  }
+
+  template<octree_value_type Data, std::size_t Exp>
+  constexpr void dynamic_octree<Data, Exp>::fill(std::span<Data const> voxels)
+  {
+    int const dim = static_cast<int>(dimension);
+    fill([&](int x, int y, int z) { return voxels[x + dim * (y + dim * z)]; });
+  }
+
+  template<octree_value_type Data, std::size_t Exp>
+  constexpr void dynamic_octree<Data, Exp>::extract(std::span<Data> voxels) const
+  {
+    int const dim = static_cast<int>(dimension);
+    auto const write_leaf = [&](dimension_value const& leaf) {
+      int const size = static_cast<int>(leaf.size);
+      for (int z = 0; z < size; ++z)
       {
-        _nodes[node_index].value = t;
-        auto parent = parent_index(node_index);
-        auto children = child_nodes(parent);
-        while (std::all_of(begin(children), end(children), [&](node const& node) { return node.value == t; }))
+        for (int y = 0; y < size; ++y)
         {
-          merge(parent, t);
-          parent = parent_index(parent);
-          children = child_nodes(parent);
+          auto const row = int(leaf.base_x) + dim * (int(leaf.base_y) + y + dim * (int(leaf.base_z) + z));
+          std::fill_n(std::next(voxels.begin(), row), size, leaf.value);
         }
-        return;
       }
-      else
-      {
-        divide(node_index);
-      }
-    }
+    };
+    visit_leaves(write_leaf);
+  }
+
+  template<octree_value_type Data, std::size_t Exp>
+  template<std::invocable<typename dynamic_octree<Data, Exp>::dimension_value const&> Visitor>
+  constexpr void dynamic_octree<Data, Exp>::visit_leaves(Visitor&& visitor) const
+  {
+    for_each_leaf(0, 0, 0, 0, static_cast<int>(dimension), visitor);
   }
 
   template<octree_value_type Data, std::size_t Exp>
@@ -120,63 +148,120 @@ namespace goop
   }
 
   template<octree_value_type Data, std::size_t Exp>
-  constexpr std::ptrdiff_t dynamic_octree<Data, Exp>::children_start_index(std::ptrdiff_t index) const
+  constexpr std::size_t dynamic_octree<Data, Exp>::node_count() const
+  {
+    return _nodes.size() - 8 * _free_blocks.size();
+  }
+
+  template<octree_value_type Data, std::size_t Exp>
+  constexpr std::size_t dynamic_octree<Data, Exp>::memory_usage() const
   {
-    return 8 + (index * 8);
+    return _nodes.capacity() * sizeof(node) + _free_blocks.capacity() * sizeof(std::uint32_t);
   }
 
   template<octree_value_type Data, std::size_t Exp>
-  constexpr std::ptrdiff_t dynamic_octree<Data, Exp>::parent_index(std::ptrdiff_t index) const
+  constexpr std::uint32_t dynamic_octree<Data, Exp>::octant(int x, int y, int z, int half_dim)
   {
-    return (index - 8) / 8;
+    return (x >= half_dim) | ((y >= half_dim) << 1) | ((z >= half_dim) << 2);
   }
 
   template<octree_value_type Data, std::size_t Exp>
-  constexpr std::ptrdiff_t dynamic_octree<Data, Exp>::next(int x, int y, int z, int half_dim, std::ptrdiff_t src) const
+  constexpr std::uint32_t dynamic_octree<Data, Exp>::allocate_children(Data value)
   {
-    int const index = (x >= half_dim) | ((y >= half_dim) << 1) | ((z >= half_dim) << 2);
-    return children_start_index(src) + index;
+    std::uint32_t offset = 0;
+    if (_free_blocks.empty())
+    {
+      offset = static_cast<std::uint32_t>(_nodes.size());
+      _nodes.resize(_nodes.size() + 8);
+    }
+    else
+    {
+      offset = _free_blocks.back();
+      _free_blocks.pop_back();
+    }
+
+    std::fill_n(std::next(_nodes.begin(), offset), 8, node{ .children = 0, .value = value });
+    return offset;
   }
 
   template<octree_value_type Data, std::size_t Exp>
-  constexpr std::span<typename dynamic_octree<Data, Exp>::node const> dynamic_octree<Data, Exp>::child_nodes(std::ptrdiff_t index) const
+  constexpr void dynamic_octree<Data, Exp>::release_children(std::uint32_t offset)
   {
-    return { &_nodes[children_start_index(index)], 8 };
+    // Blocks at the end of the pool can be dropped directly, which keeps the pool compact when
+    // nodes are merged in the same order they were divided.
+    if (offset + 8 == _nodes.size())
+      _nodes.resize(offset);
+    else
+      _free_blocks.push_back(offset);
   }
 
   template<octree_value_type Data, std::size_t Exp>
-  constexpr void dynamic_octree<Data, Exp>::merge(std::ptrdiff_t index, std::optional<Data> with_value)
+  template<typename Generator>
+  constexpr void dynamic_octree<Data, Exp>::build(std::uint32_t index, int x, int y, int z, int size, Generator& generator)
   {
-    if (index >= _nodes.size())
+    if (size == 1)
+    {
+      _nodes[index] = node{ .children = 0, .value = generator(x, y, z) };
       return;
+    }
 
-    if (!_nodes[index].value)
+    int const half = size / 2;
+    if (half == 1)
     {
-      auto const children_index = children_start_index(index);
-      for (std::ptrdiff_t i = 0; i < 8; ++i)
-      {
-        auto const child = i + children_index;
+      // Evaluate the lowest level on the stack, so that uniform blocks never touch the pool.
+      std::array<Data, 8> values{};
+      for (std::uint32_t i = 0; i < 8; ++i)
+        values[i] = generator(x + int(i & 1), y + int((i >> 1) & 1), z + int((i >> 2) & 1));
 
-        merge(child, std::nullopt);
+      if (std::all_of(values.begin(), values.end(), [&](Data v) { return v == values[0]; }))
+      {
+        _nodes[index] = node{ .children = 0, .value = values[0] };
+        return;
       }
+
+      auto const children = allocate_children(Data{});
+      for (std::uint32_t i = 0; i < 8; ++i)
+        _nodes[children + i].value = values[i];
+      _nodes[index].children = children;
+      return;
     }
 
-    _nodes[index].value = with_value;
+    auto const children = allocate_children(Data{});
+    for (std::uint32_t i = 0; i < 8; ++i)
+      build(children + i, x + int(i & 1) * half, y + int((i >> 1) & 1) * half, z + int((i >> 2) & 1) * half, half, generator);
+
+    // All grandchildren of a uniform block have been released already, so the block is the last
+    // one in the pool and gets truncated away.
+    auto const begin = std::next(_nodes.begin(), children);
+    auto const first = _nodes[children].value;
+    if (std::all_of(begin, std::next(begin, 8), [&](node const& n) { return n.children == 0 && n.value == first; }))
+    {
+      release_children(children);
+      _nodes[index] = node{ .children = 0, .value = first };
+      return;
+    }
+    _nodes[index].children = children;
   }
 
   template<octree_value_type Data, std::size_t Exp>
-  constexpr void dynamic_octree<Data, Exp>::divide(std::ptrdiff_t index)
+  template<typename Visitor>
+  constexpr void dynamic_octree<Data, Exp>::for_each_leaf(std::uint32_t index, int x, int y, int z, int size, Visitor& visitor) const
   {
-    if (!_nodes[index].value || children_start_index(index) >= _nodes.size())
-      return;
-
-    auto const children_index = children_start_index(index);
-    for (std::ptrdiff_t i = 0; i < 8; ++i)
+    auto const& n = _nodes[index];
+    if (n.children == 0)
     {
-      auto const child = i + children_index;
-      _nodes[child].value = _nodes[index].value;
+      visitor(dimension_value{
+        .base_x = static_cast<std::size_t>(x),
+        .base_y = static_cast<std::size_t>(y),
+        .base_z = static_cast<std::size_t>(z),
+        .size = static_cast<std::size_t>(size),
+        .value = n.value
+        });
+      return;
     }
 
-    _nodes[index].value = std::nullopt;
+    int const half = size / 2;
+    for (std::uint32_t i = 0; i < 8; ++i)
+      for_each_leaf(n.children + i, x + int(i & 1) * half, y + int((i >> 1) & 1) * half, z + int((i >> 2) & 1) * half, half, visitor);
   }
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 namespace goop
 {
+  class draw_state_base;
   class buffer_base
   {
   public:
@@ -14,6 +15,8 @@ namespace goop
     void load(std::byte const* data, std::size_t data_size, std::ptrdiff_t offset = 0);
 
     virtual std::size_t size() const = 0;
+    // Binds the buffer as a shader storage buffer.
+    virtual void bind(draw_state_base& state, std::uint32_t binding) const = 0;
 
   protected:
     virtual void load_impl(std::byte const* data, std::size_t data_size, std::ptrdiff_t offset = 0) = 0;
@@ -168,6 +168,8 @@ namespace goop
     virtual void use_buffer(draw_state_base& state, std::size_t binding, handle_ref<buffer_base> buffer, std::ptrdiff_t offset = 0) = 0;
     virtual void draw_indexed(draw_state_base& state, primitive_type type, draw_info_indexed const& info) = 0;
     virtual void draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset = 0) = 0;
+    // Reads the number of commands to draw as a std::uint32_t from count_buffer, which may be written on the GPU.
+    virtual void draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, buffer_base const& count_buffer, std::size_t max_count, std::ptrdiff_t offset = 0, std::ptrdiff_t count_offset = 0) = 0;
     virtual void draw_array(draw_state_base& state, primitive_type type, draw_info_array const& info) = 0;
     virtual void draw_array(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset = 0) = 0;
   };
@@ -0,0 +1,66 @@
+#include "ring_buffer.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+namespace goop
+{
+  void ring_buffer_base::reserve(std::size_t capacity, std::size_t frames_in_flight)
+  {
+    // Frames still in use by the GPU must not be overwritten by the new storage.
+    if (_allocator)
+    {
+      end_frame();
+      while (_allocator->pending_frames() != 0)
+        reclaim(true);
+    }
+
+    _allocator.emplace(capacity);
+    _frames_in_flight = std::max<std::size_t>(frames_in_flight, 1);
+    _data = create_storage(capacity);
+  }
+
+  ring_allocation ring_buffer_base::allocate(std::size_t size, std::size_t alignment)
+  {
+    if (!_allocator)
+      throw std::invalid_argument("Ring buffer storage has not been reserved.");
+
+    reclaim(false);
+    auto offset = _allocator->allocate(size, alignment);
+    while (!offset)
+    {
+      if (_allocator->pending_frames() == 0)
+        throw std::invalid_argument("Ring buffer is too small for the data of a single frame.");
+
+      reclaim(true);
+      offset = _allocator->allocate(size, alignment);
+    }
+    return ring_allocation{ .offset = *offset, .data = std::span(_data + *offset, size) };
+  }
+
+  void ring_buffer_base::end_frame()
+  {
+    if (!_allocator)
+      return;
+
+    insert_fence(_allocator->end_frame());
+    while (_allocator->pending_frames() > _frames_in_flight)
+      reclaim(true);
+  }
+
+  std::size_t ring_buffer_base::capacity() const
+  {
+    return _allocator ? _allocator->capacity() : 0;
+  }
+
+  void ring_buffer_base::reclaim(bool block)
+  {
+    // Only the oldest frame may block, everything after it is retired as long as it is finished already.
+    while (auto const oldest = _allocator->oldest_pending_frame())
+    {
+      if (!wait_fence(*oldest, block))
+        return;
+      _allocator->retire(*oldest);
+      block = false;
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+#include <span>
+#include <cstring>
+#include <optional>
+#include "draw_state.hpp"
+#include "../algorithm/ring_allocator.hpp"
+
+namespace goop
+{
+  struct ring_allocation
+  {
+    std::size_t offset;
+    std::span<std::byte> data;
+  };
+
+  // Persistently mapped buffer for data that is written once per frame, like uniforms or streamed vertices.
+  // Allocations are valid until the end of the frame. Their memory is only reused once the GPU finished the frame,
+  // and at most frames_in_flight frames are queued before end_frame waits for the oldest one.
+  class ring_buffer_base
+  {
+  public:
+    static constexpr std::size_t default_alignment = 256;
+
+    ring_buffer_base() = default;
+    virtual ~ring_buffer_base() = default;
+    ring_buffer_base(ring_buffer_base const&) = delete;
+    ring_buffer_base& operator=(ring_buffer_base const&) = delete;
+
+    // The capacity has to be a multiple of every alignment used for allocations.
+    void reserve(std::size_t capacity, std::size_t frames_in_flight = 2);
+    ring_allocation allocate(std::size_t size, std::size_t alignment = default_alignment);
+    void end_frame();
+
+    template<typename T>
+    ring_allocation write(std::span<T const> items, std::size_t alignment = default_alignment);
+    template<typename T>
+    ring_allocation write(T const& item, std::size_t alignment = default_alignment);
+
+    std::size_t capacity() const;
+
+    // Binds the allocated range as a shader storage buffer.
+    virtual void bind(draw_state_base& state, std::uint32_t binding, ring_allocation const& allocation) const = 0;
+
+  protected:
+    // Creates the backing storage and returns its persistently mapped, coherent memory.
+    virtual std::byte* create_storage(std::size_t capacity) = 0;
+    virtual void insert_fence(std::uint64_t frame) = 0;
+    // Returns whether the GPU finished all commands up to the fence of the frame.
+    virtual bool wait_fence(std::uint64_t frame, bool block) = 0;
+    // Called once write filled the allocation.
+    virtual void flush(ring_allocation const& allocation) = 0;
+
+  private:
+    void reclaim(bool block);
+
+    std::optional<ring_allocator> _allocator;
+    std::byte* _data = nullptr;
+    std::size_t _frames_in_flight = 2;
+  };
+
+  template<typename T>
+  ring_allocation ring_buffer_base::write(std::span<T const> items, std::size_t alignment)
+  {
+    auto allocation = allocate(items.size_bytes(), alignment);
+    std::memcpy(allocation.data.data(), items.data(), items.size_bytes());
+    flush(allocation);
+    return allocation;
+  }
+
+  template<typename T>
+  ring_allocation ring_buffer_base::write(T const& item, std::size_t alignment)
+  {
+    return write(std::span(&item, 1), alignment);
+  }
+}
\ No newline at end of file
@@ -39,6 +39,8 @@ namespace goop
 
     virtual void use(shader_base const& shader) = 0;
     virtual void bind(draw_state_base& state) = 0;
+    // Runs the compute stage, shader storage writes are visible to subsequent draws and dispatches.
+    virtual void dispatch(draw_state_base& state, std::uint32_t groups_x, std::uint32_t groups_y = 1, std::uint32_t groups_z = 1) = 0;
 
   };
 }
\ No newline at end of file
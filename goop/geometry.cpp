@@ -1,17 +1,48 @@
 #include "geometry.hpp"
+#include "voxel_vertex.hpp"
+#include "profiler.hpp"
+#include <algorithm>
 #include <numeric>
 
 namespace goop
 {
-  static constexpr GLuint attr_position = 0;
-  static constexpr GLuint attr_normal = 1;
-  static constexpr GLuint attr_uv0 = 2;
-  static constexpr GLuint attr_uv1 = 3;
-  static constexpr GLuint attr_uv2 = 4;
-  static constexpr GLuint attr_color = 5;
-  static constexpr GLuint attr_joints = 6;
-  static constexpr GLuint attr_weights = 7;
-  static constexpr GLuint buffer_binding = 0;
+  static constexpr std::uint32_t attr_position = 0;
+  static constexpr std::uint32_t attr_normal = 1;
+  static constexpr std::uint32_t attr_uv0 = 2;
+  static constexpr std::uint32_t attr_uv1 = 3;
+  static constexpr std::uint32_t attr_uv2 = 4;
+  static constexpr std::uint32_t attr_color = 5;
+  static constexpr std::uint32_t attr_joints = 6;
+  static constexpr std::uint32_t attr_weights = 7;
+  static constexpr std::uint32_t attr_voxel_position_face = 0;
+  static constexpr std::uint32_t attr_voxel_material = 1;
+  static constexpr std::uint32_t buffer_binding = 0;
+
+  // Adds [first, last) to the ranges, merging it with all ranges it overlaps or touches.
+  static void mark_dirty(std::vector<std::pair<std::size_t, std::size_t>>& ranges, std::size_t first, std::size_t last)
+  {
+    if (first >= last)
+      return;
+
+    auto begin = std::lower_bound(ranges.begin(), ranges.end(), first, [](auto const& range, std::size_t value) { return range.second < value; });
+    auto end = begin;
+    while (end != ranges.end() && end->first <= last)
+    {
+      first = std::min(first, end->first);
+      last = std::max(last, end->second);
+      ++end;
+    }
+    begin = ranges.erase(begin, end);
+    ranges.insert(begin, { first, last });
+  }
+
+  static void clip_dirty(std::vector<std::pair<std::size_t, std::size_t>>& ranges, std::size_t size)
+  {
+    while (!ranges.empty() && ranges.back().first >= size)
+      ranges.pop_back();
+    if (!ranges.empty())
+      ranges.back().second = std::min(ranges.back().second, size);
+  }
 
   vertex mix(vertex const& lhs, vertex const& rhs, float t)
   {
@@ -26,77 +57,217 @@ namespace goop
     return v;
   }
 
-  geometry_base::~geometry_base() = default;
+  void set_vertex_format(geometry_format_base& format, std::size_t binding, std::type_identity<vertex>)
+  {
+    format.set_attribute(attr_position, attribute_for<false>(binding, &vertex::position));
+    format.set_attribute(attr_normal, attribute_for<false>(binding, &vertex::normal));
+    format.set_attribute(attr_uv0, attribute_for<false>(binding, &vertex::uv, 0));
+    format.set_attribute(attr_uv1, attribute_for<false>(binding, &vertex::uv, 1));
+    format.set_attribute(attr_uv2, attribute_for<false>(binding, &vertex::uv, 2));
+    format.set_attribute(attr_color, attribute_for<true>(binding, &vertex::color));
+    format.set_attribute(attr_weights, attribute_for<false>(binding, &vertex::weights));
+    format.set_attribute(attr_joints, attribute_for<false>(binding, &vertex::joints));
+    format.set_binding(binding, sizeof(vertex));
+  }
+
+  void set_vertex_format(geometry_format_base& format, std::size_t binding, std::type_identity<voxel_vertex>)
+  {
+    format.set_attribute(attr_voxel_position_face, attribute_for<false>(binding, &voxel_vertex::position_face));
+    format.set_attribute(attr_voxel_material, attribute_for<false>(binding, &voxel_vertex::material));
+    format.set_binding(binding, sizeof(voxel_vertex));
+  }
+
+  template<typename Vertex>
+  basic_geometry<Vertex>::~basic_geometry() = default;
 
-  void geometry_base::clear()
+  template<typename Vertex>
+  void basic_geometry<Vertex>::clear()
   {
     std::unique_lock lock(_data_mutex);
     _staging_vertices.clear();
     _staging_indices.clear();
+    _dirty_vertices.clear();
+    _dirty_indices.clear();
+    _vertex_ranges.clear();
+    _index_ranges.clear();
+    _ranges.clear();
     _dirty = true;
   }
 
-  void geometry_base::free_client_memory()
+  template<typename Vertex>
+  void basic_geometry<Vertex>::free_client_memory()
   {
     std::unique_lock lock(_data_mutex);
+    // Pending changes still refer to the staging data.
+    if (_dirty)
+      prepare();
     _staging_vertices.clear();
     _staging_vertices.shrink_to_fit();
     _staging_indices.clear();
     _staging_indices.shrink_to_fit();
   }
 
-  void geometry_base::set_display_type(goop::display_type type)
+  template<typename Vertex>
+  void basic_geometry<Vertex>::set_display_type(goop::display_type type)
   {
     _display_type = type;
   }
 
-  display_type geometry_base::display_type() const
+  template<typename Vertex>
+  display_type basic_geometry<Vertex>::display_type() const
   {
     return _display_type;
   }
 
-  vertex_offset geometry_base::append_vertices(std::span<vertex const> vertices, std::span<index_type const> indices)
+  template<typename Vertex>
+  vertex_offset basic_geometry<Vertex>::append_vertices(std::span<Vertex const> vertices, std::span<index_type const> indices)
   {
-    auto const offset = append_empty_vertices(vertices.size(), indices.size());
-
     std::unique_lock lock(_data_mutex);
+    auto const offset = allocate(vertices.size(), indices.size());
     std::copy(begin(vertices), end(vertices), std::next(_staging_vertices.begin(), offset.vertex_offset));
     if (!indices.empty())
       std::copy(begin(indices), end(indices), std::next(_staging_indices.begin(), offset.index_offset));
 
+    mark_dirty(_dirty_vertices, offset.vertex_offset, offset.vertex_offset + offset.vertex_count);
+    mark_dirty(_dirty_indices, offset.index_offset, offset.index_offset + offset.index_count);
     _dirty = true;
 
     return offset;
   }
 
-  vertex_offset geometry_base::append_empty_vertices(std::size_t vertex_count, std::size_t index_count)
+  template<typename Vertex>
+  vertex_offset basic_geometry<Vertex>::append_empty_vertices(std::size_t vertex_count, std::size_t index_count)
   {
+    std::unique_lock lock(_data_mutex);
+    auto const offset = allocate(vertex_count, index_count);
+
+    mark_dirty(_dirty_vertices, offset.vertex_offset, offset.vertex_offset + offset.vertex_count);
+    mark_dirty(_dirty_indices, offset.index_offset, offset.index_offset + offset.index_count);
+    _dirty = true;
+
+    return offset;
+  }
+
+  template<typename Vertex>
+  vertex_offset basic_geometry<Vertex>::allocate(std::size_t vertex_count, std::size_t index_count)
+  {
+    auto const total_indices = index_count == 0 ? vertex_count : index_count;
     vertex_offset const offset{
-      .vertex_offset = static_cast<ptrdiff_t>(_staging_vertices.size()),
+      .vertex_offset = static_cast<ptrdiff_t>(_vertex_ranges.allocate(vertex_count)),
       .vertex_count = vertex_count,
-      .index_offset = static_cast<ptrdiff_t>(_staging_indices.size()),
-      .index_count = index_count == 0 ? vertex_count : index_count
+      .index_offset = static_cast<ptrdiff_t>(_index_ranges.allocate(total_indices)),
+      .index_count = total_indices
     };
 
-    std::unique_lock lock(_data_mutex);
-    _staging_indices.resize(_staging_indices.size() + offset.index_count);
-    _staging_vertices.resize(_staging_vertices.size() + vertex_count);
+    if (_staging_indices.size() < _index_ranges.size())
+      _staging_indices.resize(_index_ranges.size());
+    if (_staging_vertices.size() < _vertex_ranges.size())
+      _staging_vertices.resize(_vertex_ranges.size());
 
     // If index count not specified or set to zero, assume a 1:1 relation between vertices and indices.
     if (index_count == 0)
     {
-      std::iota(std::next(_staging_indices.begin(), offset.index_offset), _staging_indices.end(), /*static_cast<index_type>(offset.vertex_offset)*/0);
+      auto const first = std::next(_staging_indices.begin(), offset.index_offset);
+      std::iota(first, std::next(first, offset.index_count), /*static_cast<index_type>(offset.vertex_offset)*/0);
     }
-    _dirty = true;
+    // Every non-empty range has indices, while an index-only range shares its vertex offset with other ranges.
+    if (total_indices != 0)
+      _ranges.emplace(offset.index_offset, offset);
 
     return offset;
   }
-  void geometry_base::draw(draw_state_base& state, vertex_offset offset)
+  template<typename Vertex>
+  void basic_geometry<Vertex>::release(vertex_offset offset)
+  {
+    // Empty ranges are not tracked, their offset may belong to another range.
+    if (offset.index_count == 0)
+      return;
+
+    std::unique_lock lock(_data_mutex);
+    if (_ranges.erase(offset.index_offset) == 0)
+      return;
+
+    if (offset.vertex_count != 0)
+      _vertex_ranges.release(offset.vertex_offset);
+    _index_ranges.release(offset.index_offset);
+  }
+
+  template<typename Vertex>
+  std::vector<std::pair<vertex_offset, vertex_offset>> basic_geometry<Vertex>::compact()
+  {
+    std::unique_lock lock(_data_mutex);
+    if (_staging_vertices.size() < _vertex_ranges.size() || _staging_indices.size() < _index_ranges.size())
+      throw std::invalid_argument("Cannot compact geometry after its client memory was freed.");
+
+    // Relocations move ranges towards the front in ascending order, so copying forward never overwrites unmoved data.
+    auto const relocate = [](auto& staging, range_allocator& ranges, dirty_ranges& dirty) {
+      auto const relocations = ranges.compact();
+      std::map<std::size_t, std::size_t> moved;
+      for (auto const& r : relocations)
+      {
+        std::copy_n(std::next(staging.begin(), r.from), r.count, std::next(staging.begin(), r.to));
+        moved.emplace(r.from, r.to);
+      }
+      staging.resize(ranges.size());
+      clip_dirty(dirty, ranges.size());
+      if (!relocations.empty())
+        mark_dirty(dirty, relocations.front().to, ranges.size());
+      return moved;
+    };
+    auto const moved_vertices = relocate(_staging_vertices, _vertex_ranges, _dirty_vertices);
+    auto const moved_indices = relocate(_staging_indices, _index_ranges, _dirty_indices);
+
+    std::vector<std::pair<vertex_offset, vertex_offset>> result;
+    std::map<std::ptrdiff_t, vertex_offset> ranges;
+    for (auto const& [key, range] : _ranges)
+    {
+      auto moved = range;
+      if (auto const it = moved_vertices.find(range.vertex_offset); range.vertex_count != 0 && it != moved_vertices.end())
+        moved.vertex_offset = static_cast<std::ptrdiff_t>(it->second);
+      if (auto const it = moved_indices.find(range.index_offset); it != moved_indices.end())
+        moved.index_offset = static_cast<std::ptrdiff_t>(it->second);
+
+      if (moved.vertex_offset != range.vertex_offset || moved.index_offset != range.index_offset)
+        result.emplace_back(range, moved);
+      ranges.emplace(moved.index_offset, moved);
+    }
+    _ranges = std::move(ranges);
+
+    // Culled draws refer to their range by its offsets, which have to follow the moved ranges.
+    auto const culled = _drawer->culled_draws();
+    for (std::uint32_t id = 0; id < culled.size(); ++id)
+    {
+      auto const& draw = culled[id];
+      auto const moved = std::find_if(result.begin(), result.end(), [&](auto const& r) { return r.first.index_offset == draw.command.first_index; });
+      if (draw.command.instance_count == 0 || moved == result.end())
+        continue;
+
+      auto info = draw.command;
+      info.first_index = std::uint32_t(moved->second.index_offset);
+      info.base_vertex = std::uint32_t(moved->second.vertex_offset);
+      _drawer->update_culled(id, info, rnu::vec3(draw.bounds_min.x, draw.bounds_min.y, draw.bounds_min.z),
+        rnu::vec3(draw.bounds_max.x, draw.bounds_max.y, draw.bounds_max.z));
+    }
+
+    _dirty = _dirty || !_dirty_vertices.empty() || !_dirty_indices.empty();
+    return result;
+  }
+
+  template<typename Vertex>
+  geometry_stats basic_geometry<Vertex>::stats() const
+  {
+    std::unique_lock lock(_data_mutex);
+    return geometry_stats{ .vertices = _vertex_ranges.stats(), .indices = _index_ranges.stats() };
+  }
+
+  template<typename Vertex>
+  void basic_geometry<Vertex>::draw(draw_state_base& state, vertex_offset offset)
   {
     // don't need this here.
     draw(state, std::initializer_list{ offset });
   }
-  void geometry_base::draw(draw_state_base& state, std::span<vertex_offset const> offsets)
+  template<typename Vertex>
+  void basic_geometry<Vertex>::draw(draw_state_base& state, std::span<vertex_offset const> offsets)
   {
     // don't need this here.
     (void)state;
@@ -107,64 +278,108 @@ namespace goop
 
     draw_ranges(state, offsets);
   }
-  void geometry_base::prepare()
+  template<typename Vertex>
+  std::uint32_t basic_geometry<Vertex>::add_culled(vertex_offset offset, rnu::vec3 min, rnu::vec3 max)
   {
-    upload(_staging_vertices, _staging_indices);
+    std::unique_lock lock(_data_mutex);
+    draw_info_indexed info{
+      .count = std::uint32_t(offset.index_count),
+      .instance_count = 1,
+      .first_index = std::uint32_t(offset.index_offset),
+      .base_vertex = std::uint32_t(offset.vertex_offset),
+      .base_instance = 0
+    };
+    auto const id = _drawer->add_culled(info, min, max);
+    info.base_instance = id;
+    _drawer->update_culled(id, info, min, max);
+    return id;
+  }
+
+  template<typename Vertex>
+  void basic_geometry<Vertex>::remove_culled(std::uint32_t id)
+  {
+    std::unique_lock lock(_data_mutex);
+    _drawer->remove_culled(id);
+  }
+
+  template<typename Vertex>
+  void basic_geometry<Vertex>::draw_culled(draw_state_base& state, shader_pipeline& pipeline, frustum const& frustum)
+  {
+    std::unique_lock lock(_data_mutex);
+    if (_dirty)
+      prepare();
+
+    _drawer->draw_culled(state, pipeline, primitive(), frustum);
+  }
+
+  template<typename Vertex>
+  void basic_geometry<Vertex>::prepare()
+  {
+    upload();
     _dirty = false;
   }
 
-  void geometry_base::upload(std::span<vertex const> vertices, std::span<geometry_base::index_type const> indices)
+  template<typename Vertex>
+  void basic_geometry<Vertex>::upload()
   {
+    GOOP_PROFILE_ZONE("geometry::upload");
     if (!_geometry)
     {
       _geometry = geometry_format();
       auto& geo = _geometry.value();
-      geo->set_attribute(attr_position, attribute_for<false>(buffer_binding, &vertex::position));
-      geo->set_attribute(attr_normal, attribute_for<false>(buffer_binding, &vertex::normal));
-      geo->set_attribute(attr_uv0, attribute_for<false>(buffer_binding, &vertex::uv, 0));
-      geo->set_attribute(attr_uv1, attribute_for<false>(buffer_binding, &vertex::uv, 1));
-      geo->set_attribute(attr_uv2, attribute_for<false>(buffer_binding, &vertex::uv, 2));
-      geo->set_attribute(attr_color, attribute_for<true>(buffer_binding, &vertex::color));
-      geo->set_attribute(attr_weights, attribute_for<false>(buffer_binding, &vertex::weights));
-      geo->set_attribute(attr_joints, attribute_for<false>(buffer_binding, &vertex::joints));
-      geo->set_binding(buffer_binding, sizeof(vertex));
+      set_vertex_format(*geo, buffer_binding, std::type_identity<Vertex>{});
 
       _drawer->set_geometry(geo);
     }
 
-    _drawer->clear_append_cursor();
-    _drawer->append_data(vertices, indices);
+    // Only the changed spans are uploaded, so appending to a large geometry costs as much as the appended data.
+    std::span<Vertex const> const vertices = _staging_vertices;
+    std::span<index_type const> const indices = _staging_indices;
+    for (auto const& [first, last] : _dirty_vertices)
+      _drawer->update_vertices(vertices.subspan(first, last - first), first);
+    for (auto const& [first, last] : _dirty_indices)
+      _drawer->update_indices(indices.subspan(first, last - first), first);
+    _dirty_vertices.clear();
+    _dirty_indices.clear();
   }
 
-  void geometry_base::draw_ranges(draw_state_base& state, std::span<vertex_offset const> offsets)
+  template<typename Vertex>
+  void basic_geometry<Vertex>::draw_ranges(draw_state_base& state, std::span<vertex_offset const> offsets)
   {
+    // The base instance of each draw is its position in offsets, so shaders can look up per-draw data with gl_BaseInstance.
     _drawer->clear_queue();
-    for (auto const& i : offsets)
+    for (std::size_t draw = 0; draw < offsets.size(); ++draw)
     {
+      auto const& i = offsets[draw];
       draw_info_indexed const info{
         .count = std::uint32_t(i.index_count),
         .instance_count = 1,
         .first_index = std::uint32_t(i.index_offset),
         .base_vertex = std::uint32_t(i.vertex_offset),
-        .base_instance = 0
+        .base_instance = std::uint32_t(draw)
       };
       _drawer->enqueue(info);
     }
 
-    auto const primitive = [&] {
-      switch (_display_type)
-      {
-      case display_type::surfaces:
-        return primitive_type::triangles;
-      case display_type::outlines:
-        return primitive_type::line_strip;
-      case display_type::vertices:
-        return primitive_type::points;
-      default:
-        return primitive_type::triangles;
-      }
-    }();
+    _drawer->draw(state, primitive());
+  }
 
-    _drawer->draw(state, primitive);
+  template<typename Vertex>
+  primitive_type basic_geometry<Vertex>::primitive() const
+  {
+    switch (_display_type)
+    {
+    case display_type::surfaces:
+      return primitive_type::triangles;
+    case display_type::outlines:
+      return primitive_type::line_strip;
+    case display_type::vertices:
+      return primitive_type::points;
+    default:
+      return primitive_type::triangles;
+    }
   }
-}
+
+  template class basic_geometry<vertex>;
+  template class basic_geometry<voxel_vertex>;
+}
\ No newline at end of file
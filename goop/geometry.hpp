@@ -5,8 +5,11 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <type_traits>
+#include <map>
 #include "graphics.hpp"
 #include "multi_draw.hpp"
+#include "algorithm/range_allocator.hpp"
 
 namespace goop
 {
@@ -21,6 +24,7 @@ namespace goop
   };
 
   vertex mix(vertex const& lhs, vertex const& rhs, float t);
+  void set_vertex_format(geometry_format_base& format, std::size_t binding, std::type_identity<vertex>);
 
   struct vertex_offset
   {
@@ -30,6 +34,12 @@ namespace goop
     std::size_t index_count;
   };
 
+  struct geometry_stats
+  {
+    range_allocator::statistics vertices;
+    range_allocator::statistics indices;
+  };
+
   enum class display_type
   {
     surfaces,
@@ -37,42 +47,74 @@ namespace goop
     vertices
   };
 
-  class geometry_base
+  // Vertex types provide their attribute layout through an overload of
+  // set_vertex_format(geometry_format_base&, std::size_t binding, std::type_identity<Vertex>).
+  template<typename Vertex>
+  class basic_geometry
   {
   public:
+    using vertex_type = Vertex;
     using index_type = std::uint32_t;
 
-    geometry_base() = default;
-    geometry_base(geometry_base const&) = delete;
-    geometry_base& operator=(geometry_base const&) = delete;
-    geometry_base(geometry_base&&) noexcept = default;
-    geometry_base& operator=(geometry_base&&) noexcept = default;
-    ~geometry_base();
+    basic_geometry() = default;
+    basic_geometry(basic_geometry const&) = delete;
+    basic_geometry& operator=(basic_geometry const&) = delete;
+    basic_geometry(basic_geometry&&) noexcept = default;
+    basic_geometry& operator=(basic_geometry&&) noexcept = default;
+    ~basic_geometry();
 
     void set_display_type(display_type type);
     display_type display_type() const;
     void clear();
+    // Uploads pending changes before the staging data is dropped.
     void free_client_memory();
-    vertex_offset append_vertices(std::span<vertex const> vertices, std::span<index_type const> indices = {});
+    vertex_offset append_vertices(std::span<Vertex const> vertices, std::span<index_type const> indices = {});
     vertex_offset append_empty_vertices(std::size_t vertex_count, std::size_t index_count = 0);
+    // Frees a range returned by one of the append functions, later appends may reuse it.
+    void release(vertex_offset offset);
+    // Closes the gaps left by released ranges. Returns (old, new) for every range that moved.
+    // Needs the client memory, so it must not be called after free_client_memory.
+    std::vector<std::pair<vertex_offset, vertex_offset>> compact();
+    geometry_stats stats() const;
 
     void draw(draw_state_base& state, vertex_offset offset);
     void draw(draw_state_base& state, std::span<vertex_offset const> offsets);
     void prepare();
 
+    // Ranges drawn by draw_culled, which culls them against the frustum on the GPU, see multi_draw_base::draw_culled.
+    // The base instance of each culled draw is its id, so shaders can look up per-draw data with gl_BaseInstance.
+    std::uint32_t add_culled(vertex_offset offset, rnu::vec3 min, rnu::vec3 max);
+    void remove_culled(std::uint32_t id);
+    void draw_culled(draw_state_base& state, shader_pipeline& pipeline, frustum const& frustum);
+
   protected:
-    void upload(std::span<vertex const> vertices, std::span<geometry_base::index_type const> indices);
+    // Element ranges [first, second) of the staging data which changed since the last upload, sorted and disjoint.
+    using dirty_ranges = std::vector<std::pair<std::size_t, std::size_t>>;
+
+    // Allocates the ranges and grows the staging data to hold them, the caller has to hold _data_mutex.
+    vertex_offset allocate(std::size_t vertex_count, std::size_t index_count);
+    void upload();
+    primitive_type primitive() const;
     void draw_ranges(draw_state_base& state, std::span<vertex_offset const> offsets);
 
     mutable bool _dirty = false;
+    dirty_ranges _dirty_vertices;
+    dirty_ranges _dirty_indices;
     mutable std::mutex _data_mutex;
     goop::display_type _display_type;
-    std::vector<vertex> _staging_vertices;
+    std::vector<Vertex> _staging_vertices;
     std::vector<index_type> _staging_indices;
+    range_allocator _vertex_ranges;
+    range_allocator _index_ranges;
+    // Allocated ranges by index offset.
+    std::map<std::ptrdiff_t, vertex_offset> _ranges;
 
     std::optional<geometry_format> _geometry;
     multi_draw _drawer;
   };
 
+  extern template class basic_geometry<vertex>;
+
+  using geometry_base = basic_geometry<vertex>;
   using geometry = handle<geometry_base, geometry_base>;
 }
\ No newline at end of file
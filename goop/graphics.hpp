@@ -1,6 +1,9 @@
 #pragma once
 
+// Defining GOOP_RECORDING replaces OpenGL with the recording backend, which captures commands without a GPU.
+#if !GOOP_RECORDING
 #define OPENGL 1
+#endif
 
 #if OPENGL
 #include "opengl/texture.hpp"
@@ -11,6 +14,17 @@
 #include "opengl/render_target.hpp"
 #include "opengl/buffer.hpp"
 #include "opengl/geometry_format.hpp"
+#include "opengl/ring_buffer.hpp"
+#elif GOOP_RECORDING
+#include "recording/texture.hpp"
+#include "recording/shader.hpp"
+#include "recording/sampler.hpp"
+#include "recording/mapped_buffer.hpp"
+#include "recording/draw_state.hpp"
+#include "recording/render_target.hpp"
+#include "recording/buffer.hpp"
+#include "recording/geometry_format.hpp"
+#include "recording/ring_buffer.hpp"
 #endif
 
 #include "generic/texture_provider.hpp"
@@ -24,6 +38,8 @@ namespace goop
 {
 #if OPENGL
   namespace graphics_impl = opengl;
+#elif GOOP_RECORDING
+  namespace graphics_impl = recording;
 #endif
 
   using texture = handle<graphics_impl::texture, texture_base>;
@@ -31,6 +47,7 @@ namespace goop
   using sampler = handle<graphics_impl::sampler, sampler_base>;
   using render_target = handle<graphics_impl::render_target, render_target_base>;
   using geometry_format = handle<graphics_impl::geometry_format, geometry_format_base>;
+  using ring_buffer = handle<graphics_impl::ring_buffer, ring_buffer_base>;
   using texture_provider = texture_provider_base<texture>;
 
   class shader : public handle<graphics_impl::shader, shader_base>
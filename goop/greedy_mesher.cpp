@@ -0,0 +1,238 @@
+#include "greedy_mesher.hpp"
+#include <bit>
+
+namespace goop
+{
+  std::span<voxel_quad const> greedy_mesher::quads() const
+  {
+    return _quads;
+  }
+
+  std::span<voxel_quad const> greedy_mesher::quads(material_range const& range) const
+  {
+    return std::span(_quads).subspan(range.first_quad, range.quad_count);
+  }
+
+  std::span<greedy_mesher::material_range const> greedy_mesher::materials() const
+  {
+    return _materials;
+  }
+
+  void greedy_mesher::write_vertices(rnu::vec3 offset, std::vector<vertex>& vertices, std::vector<std::uint32_t>& indices) const
+  {
+    vertices.reserve(vertices.size() + _quads.size() * vertices_per_quad);
+    indices.reserve(indices.size() + _quads.size() * indices_per_quad);
+
+    std::uint32_t base = 0;
+    for (auto const& range : _materials)
+    {
+      for (auto const& quad : quads(range))
+      {
+        int const axis = static_cast<int>(quad.face) / 2;
+        bool const positive = (static_cast<int>(quad.face) % 2) == 0;
+        auto const [nx, ny, nz] = to_xyz(axis, positive ? 1 : -1, 0, 0);
+        rnu::vec3 const normal{ float(nx), float(ny), float(nz) };
+
+        std::array<rnu::vec2, 4> const uvs{
+          rnu::vec2{ 0.f, 0.f },
+          rnu::vec2{ float(quad.width), 0.f },
+          rnu::vec2{ 0.f, float(quad.height) },
+          rnu::vec2{ float(quad.width), float(quad.height) }
+        };
+
+        auto const quad_corners = corners(quad);
+        for (std::size_t i = 0; i < quad_corners.size(); ++i)
+        {
+          auto const [x, y, z] = quad_corners[i];
+          vertices.push_back(vertex{
+            .position = offset + rnu::vec3{ x - 0.5f, y - 0.5f, z - 0.5f },
+            .normal = normal,
+            .uv = { uvs[i] },
+            .color = {255, 255, 255, 255} });
+        }
+
+        for (auto const i : quad_indices(quad))
+          indices.push_back(base + i);
+        base += vertices_per_quad;
+      }
+    }
+  }
+
+  void greedy_mesher::write_vertices(std::vector<voxel_vertex>& vertices, std::vector<std::uint32_t>& indices) const
+  {
+    vertices.reserve(vertices.size() + _quads.size() * vertices_per_quad);
+    indices.reserve(indices.size() + _quads.size() * indices_per_quad);
+
+    std::uint32_t base = 0;
+    for (auto const& range : _materials)
+    {
+      for (auto const& quad : quads(range))
+      {
+        for (auto const [x, y, z] : corners(quad))
+          vertices.push_back(voxel_vertex::pack(x, y, z, quad.face, voxel_vertex::max_occlusion, quad.material));
+
+        for (auto const i : quad_indices(quad))
+          indices.push_back(base + i);
+        base += vertices_per_quad;
+      }
+    }
+  }
+
+  std::array<std::array<int, 3>, 4> greedy_mesher::corners(voxel_quad const& quad)
+  {
+    int const axis = static_cast<int>(quad.face) / 2;
+    bool const positive = (static_cast<int>(quad.face) % 2) == 0;
+
+    auto const [ox, oy, oz] = to_xyz(axis, positive ? 1 : 0, 0, 0);
+    auto const [ux, uy, uz] = to_xyz(axis, 0, quad.width, 0);
+    auto const [vx, vy, vz] = to_xyz(axis, 0, 0, quad.height);
+
+    std::array<int, 3> const origin{ quad.x + ox, quad.y + oy, quad.z + oz };
+    return {
+      origin,
+      std::array{ origin[0] + ux, origin[1] + uy, origin[2] + uz },
+      std::array{ origin[0] + vx, origin[1] + vy, origin[2] + vz },
+      std::array{ origin[0] + ux + vx, origin[1] + uy + vy, origin[2] + uz + vz }
+    };
+  }
+
+  std::array<std::uint32_t, 6> const& greedy_mesher::quad_indices(voxel_quad const& quad)
+  {
+    // The in-plane axes are ordered such that u x v points along the positive axis.
+    static constexpr std::array<std::uint32_t, 6> positive_indices{ 0u, 1u, 2u, 2u, 1u, 3u };
+    static constexpr std::array<std::uint32_t, 6> negative_indices{ 0u, 2u, 1u, 1u, 2u, 3u };
+    return (static_cast<int>(quad.face) % 2) == 0 ? positive_indices : negative_indices;
+  }
+
+  void greedy_mesher::resize(std::size_t dimension)
+  {
+    if (dimension > max_dimension)
+      throw std::invalid_argument("Chunk dimension exceeds the supported maximum of the greedy mesher.");
+
+    _dimension = dimension;
+    _voxels.resize(dimension * dimension * dimension);
+    _border.resize(6 * dimension);
+  }
+
+  void greedy_mesher::mesh_voxels()
+  {
+    int const dim = static_cast<int>(_dimension);
+    std::uint64_t const slice_mask = (std::uint64_t(1) << dim) - 1;
+
+    _active_planes = 0;
+    _quads.clear();
+    _materials.clear();
+
+    // Collect one opacity column per axis including the border bits on both ends. Visible faces are
+    // the transitions from opaque to non-opaque bits, shifted back to not include the border.
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      for (int u = 0; u < dim; ++u)
+      {
+        std::uint64_t const low_border = _border[(axis * 2 + 0) * dim + u];
+        std::uint64_t const high_border = _border[(axis * 2 + 1) * dim + u];
+
+        for (int v = 0; v < dim; ++v)
+        {
+          std::uint64_t column = ((low_border >> v) & 1) | (((high_border >> v) & 1) << (dim + 1));
+          for (int a = 0; a < dim; ++a)
+          {
+            if (voxel(to_xyz(axis, a, u, v)) != 0)
+              column |= std::uint64_t(2) << a;
+          }
+
+          std::array<std::uint64_t, 2> const faces{
+            ((column & ~(column >> 1)) >> 1) & slice_mask,
+            ((column & ~(column << 1)) >> 1) & slice_mask
+          };
+
+          for (int side = 0; side < 2; ++side)
+          {
+            auto bits = faces[side];
+            while (bits != 0)
+            {
+              int const a = std::countr_zero(bits);
+              bits &= bits - 1;
+
+              auto& rows = planes_for(voxel(to_xyz(axis, a, u, v)));
+              rows[((axis * 2 + side) * dim + a) * dim + u] |= std::uint64_t(1) << v;
+            }
+          }
+        }
+      }
+    }
+
+    std::sort(_planes.begin(), std::next(_planes.begin(), _active_planes),
+      [](material_planes const& lhs, material_planes const& rhs) { return lhs.material < rhs.material; });
+
+    for (std::size_t p = 0; p < _active_planes; ++p)
+    {
+      auto& [material, planes] = _planes[p];
+      material_range range{ .material = material, .first_quad = _quads.size(), .quad_count = 0 };
+
+      for (int face = 0; face < 6; ++face)
+      {
+        for (int a = 0; a < dim; ++a)
+        {
+          auto const rows = std::span(planes).subspan((face * dim + a) * dim, dim);
+          for (int u = 0; u < dim; ++u)
+          {
+            // Take the lowest run of bits in this row and grow it along u as long as the following
+            // rows contain the whole run.
+            while (rows[u] != 0)
+            {
+              int const v = std::countr_zero(rows[u]);
+              int const height = std::countr_one(rows[u] >> v);
+              std::uint64_t const run = ((std::uint64_t(1) << height) - 1) << v;
+
+              int width = 1;
+              while (u + width < dim && (rows[u + width] & run) == run)
+              {
+                rows[u + width] &= ~run;
+                ++width;
+              }
+              rows[u] &= ~run;
+
+              auto const [x, y, z] = to_xyz(face / 2, a, u, v);
+              _quads.push_back(voxel_quad{
+                .x = std::uint8_t(x),
+                .y = std::uint8_t(y),
+                .z = std::uint8_t(z),
+                .width = std::uint8_t(width),
+                .height = std::uint8_t(height),
+                .face = static_cast<voxel_face>(face),
+                .material = material
+                });
+            }
+          }
+        }
+      }
+
+      range.quad_count = _quads.size() - range.first_quad;
+      if (range.quad_count != 0)
+        _materials.push_back(range);
+    }
+  }
+
+  std::vector<std::uint64_t>& greedy_mesher::planes_for(std::uint16_t material)
+  {
+    for (std::size_t i = 0; i < _active_planes; ++i)
+    {
+      if (_planes[i].material == material)
+        return _planes[i].rows;
+    }
+
+    if (_active_planes == _planes.size())
+      _planes.emplace_back();
+
+    auto& planes = _planes[_active_planes++];
+    planes.material = material;
+    planes.rows.assign(6 * _dimension * _dimension, 0);
+    return planes.rows;
+  }
+
+  std::uint16_t greedy_mesher::voxel(std::array<int, 3> const& p) const
+  {
+    return _voxels[p[0] + _dimension * (p[1] + _dimension * p[2])];
+  }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <rnu/math/math.hpp>
+#include "dynamic_octree.hpp"
+#include "geometry.hpp"
+#include "voxel_vertex.hpp"
+
+namespace goop
+{
+  // A merged rectangle of coplanar block faces of the same material.
+  // x, y, z is the block with the smallest coordinates covered by the quad, width and height extend
+  // it along the two in-plane axes (x: y, z | y: z, x | z: x, y).
+  struct voxel_quad
+  {
+    std::uint8_t x;
+    std::uint8_t y;
+    std::uint8_t z;
+    std::uint8_t width;
+    std::uint8_t height;
+    voxel_face face;
+    std::uint16_t material;
+  };
+
+  class greedy_mesher
+  {
+  public:
+    static constexpr std::size_t max_dimension = 62;
+    static constexpr std::size_t vertices_per_quad = 4;
+    static constexpr std::size_t indices_per_quad = 6;
+
+    struct material_range
+    {
+      std::uint16_t material;
+      std::size_t first_quad;
+      std::size_t quad_count;
+    };
+
+    // Meshes all non-zero blocks of the chunk. is_border_opaque(x, y, z) is queried once for every
+    // block of the one block thick shell around the chunk, where one of the coordinates is -1 or border_size().
+    template<std::size_t Exp, std::predicate<int, int, int> BorderFn>
+    void mesh(dynamic_octree<std::uint16_t, Exp> const& chunk, BorderFn&& is_border_opaque);
+
+    // Quads are sorted by material.
+    std::span<voxel_quad const> quads() const;
+    std::span<voxel_quad const> quads(material_range const& range) const;
+    std::span<material_range const> materials() const;
+
+    // Writes 4 vertices and 6 indices per quad, blocks are centered around their integer coordinates.
+    // The indices are relative to the first vertex written, so all materials can be drawn as a single range.
+    void write_vertices(rnu::vec3 offset, std::vector<vertex>& vertices, std::vector<std::uint32_t>& indices) const;
+    // Same layout, but with chunk-local packed vertices.
+    void write_vertices(std::vector<voxel_vertex>& vertices, std::vector<std::uint32_t>& indices) const;
+
+  private:
+    struct material_planes
+    {
+      std::uint16_t material;
+      // One row of bits per face, slice and first in-plane axis, the bits are the second in-plane axis.
+      std::vector<std::uint64_t> rows;
+    };
+
+    static constexpr std::array<int, 3> to_xyz(int axis, int a, int u, int v);
+    static std::array<std::array<int, 3>, 4> corners(voxel_quad const& quad);
+    static std::array<std::uint32_t, 6> const& quad_indices(voxel_quad const& quad);
+
+    void resize(std::size_t dimension);
+    void mesh_voxels();
+    std::vector<std::uint64_t>& planes_for(std::uint16_t material);
+    std::uint16_t voxel(std::array<int, 3> const& p) const;
+
+    std::size_t _dimension = 0;
+    std::vector<std::uint16_t> _voxels;
+    std::vector<std::uint64_t> _border;
+    std::vector<material_planes> _planes;
+    std::size_t _active_planes = 0;
+    std::vector<voxel_quad> _quads;
+    std::vector<material_range> _materials;
+  };
+
+  template<std::size_t Exp, std::predicate<int, int, int> BorderFn>
+  void greedy_mesher::mesh(dynamic_octree<std::uint16_t, Exp> const& chunk, BorderFn&& is_border_opaque)
+  {
+    resize(chunk.border_size());
+    chunk.extract(_voxels);
+
+    int const dim = static_cast<int>(_dimension);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      for (int side = 0; side < 2; ++side)
+      {
+        for (int u = 0; u < dim; ++u)
+        {
+          std::uint64_t bits = 0;
+          for (int v = 0; v < dim; ++v)
+          {
+            auto const [x, y, z] = to_xyz(axis, side == 0 ? -1 : dim, u, v);
+            if (is_border_opaque(x, y, z))
+              bits |= std::uint64_t(1) << v;
+          }
+          _border[(axis * 2 + side) * dim + u] = bits;
+        }
+      }
+    }
+    mesh_voxels();
+  }
+
+  constexpr std::array<int, 3> greedy_mesher::to_xyz(int axis, int a, int u, int v)
+  {
+    switch (axis)
+    {
+    case 0:
+      return { a, u, v };
+    case 1:
+      return { v, a, u };
+    default:
+      return { u, v, a };
+    }
+  }
+}
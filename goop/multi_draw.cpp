@@ -1,7 +1,80 @@
 #include "multi_draw.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <string>
 
 namespace goop
 {
+  namespace
+  {
+    constexpr std::uint32_t compaction_group_size = 64;
+
+    // The version and the defines for the group size and the bindings are prepended by compaction_shader_source.
+    constexpr auto compaction_shader_body = R"(
+layout(local_size_x = COMPACTION_GROUP_SIZE) in;
+
+struct draw_command
+{
+  uint count;
+  uint instance_count;
+  uint first_index;
+  uint base_vertex;
+  uint base_instance;
+};
+
+struct culled_draw
+{
+  draw_command command;
+  uint padding0;
+  uint padding1;
+  uint padding2;
+  vec4 bounds_min;
+  vec4 bounds_max;
+};
+
+layout(std430, binding = COMPACTION_BINDING + 0) restrict readonly buffer Draws { culled_draw draws[]; };
+layout(std430, binding = COMPACTION_BINDING + 1) restrict readonly buffer Parameters { vec4 planes[6]; uint draw_count; };
+layout(std430, binding = COMPACTION_BINDING + 2) restrict writeonly buffer Commands { draw_command commands[]; };
+layout(std430, binding = COMPACTION_BINDING + 3) restrict buffer Count { uint visible_count; };
+
+void main()
+{
+  uint id = gl_GlobalInvocationID.x;
+  if (id >= draw_count || draws[id].command.instance_count == 0)
+    return;
+
+  vec3 bounds_min = draws[id].bounds_min.xyz;
+  vec3 bounds_max = draws[id].bounds_max.xyz;
+  for (int i = 0; i < 6; ++i)
+  {
+    vec4 plane = planes[i];
+    vec3 outer = mix(bounds_min, bounds_max, greaterThanEqual(plane.xyz, vec3(0)));
+    if (plane.x * outer.x + plane.y * outer.y + plane.z * outer.z + plane.w < 0)
+      return;
+  }
+  commands[atomicAdd(visible_count, 1)] = draws[id].command;
+}
+)";
+
+    std::string compaction_shader_source()
+    {
+      return "#version 460 core\n"
+        "#define COMPACTION_GROUP_SIZE " + std::to_string(compaction_group_size) + "\n"
+        "#define COMPACTION_BINDING " + std::to_string(multi_draw_base::compaction_binding) + "\n" +
+        compaction_shader_body;
+    }
+
+    culled_draw make_culled_draw(draw_info_indexed const& info, rnu::vec3 min, rnu::vec3 max)
+    {
+      return culled_draw{
+        .command = info,
+        .padding = {},
+        .bounds_min = rnu::vec4(min.x, min.y, min.z, 1),
+        .bounds_max = rnu::vec4(max.x, max.y, max.z, 1)
+      };
+    }
+  }
+
   void multi_draw_base::set_geometry(handle_ref<geometry_format_base> geometry)
   {
     _geometry = std::move(geometry);
@@ -13,6 +86,15 @@ namespace goop
     if (indirect_buffer_size > 0)
       _indirect_buffer->load(nullptr, indirect_buffer_size);
   }
+  void multi_draw_base::reserve(buffer& target, std::size_t bytes)
+  {
+    auto const size = target->size();
+    if (size >= bytes)
+      return;
+
+    // Growing with the old size as offset keeps the existing contents.
+    target->load(nullptr, std::max(bytes, 2 * size) - size, size);
+  }
   void multi_draw_base::clear_queue()
   {
     _current_hash = 0;
@@ -25,6 +107,7 @@ namespace goop
   }
   void multi_draw_base::draw(draw_state_base& state, primitive_type primitive)
   {
+    GOOP_PROFILE_ZONE("multi_draw::draw");
     if (!_geometry)
       return;
 
@@ -38,4 +121,94 @@ namespace goop
     _geometry->get().use_index_buffer(state, _index_size.value(), _index_buffer);
     _geometry->get().draw_indexed(state, primitive, _indirect_buffer, _draw_commands.size());
   }
+
+  std::uint32_t multi_draw_base::add_culled(draw_info_indexed const& info, rnu::vec3 min, rnu::vec3 max)
+  {
+    _culled_dirty = true;
+    if (!_free_culled.empty())
+    {
+      auto const id = _free_culled.back();
+      _free_culled.pop_back();
+      _culled_draws[id] = make_culled_draw(info, min, max);
+      return id;
+    }
+
+    _culled_draws.push_back(make_culled_draw(info, min, max));
+    return std::uint32_t(_culled_draws.size() - 1);
+  }
+  void multi_draw_base::update_culled(std::uint32_t id, draw_info_indexed const& info, rnu::vec3 min, rnu::vec3 max)
+  {
+    if (id >= _culled_draws.size())
+      throw std::invalid_argument("Culled draw id out of range.");
+    if (std::find(_free_culled.begin(), _free_culled.end(), id) != _free_culled.end())
+      throw std::invalid_argument("Culled draw id was removed.");
+
+    _culled_dirty = true;
+    _culled_draws[id] = make_culled_draw(info, min, max);
+  }
+  void multi_draw_base::remove_culled(std::uint32_t id)
+  {
+    if (id >= _culled_draws.size())
+      throw std::invalid_argument("Culled draw id out of range.");
+    if (std::find(_free_culled.begin(), _free_culled.end(), id) != _free_culled.end())
+      throw std::invalid_argument("Culled draw id was removed.");
+
+    // Draws without instances are skipped by the compaction.
+    _culled_dirty = true;
+    _culled_draws[id].command.instance_count = 0;
+    _free_culled.push_back(id);
+  }
+  void multi_draw_base::clear_culled()
+  {
+    _culled_dirty = true;
+    _culled_draws.clear();
+    _free_culled.clear();
+  }
+  std::span<culled_draw const> multi_draw_base::culled_draws() const
+  {
+    return _culled_draws;
+  }
+  void multi_draw_base::draw_culled(draw_state_base& state, shader_pipeline& pipeline, primitive_type primitive, frustum const& frustum)
+  {
+    GOOP_PROFILE_ZONE("multi_draw::draw_culled");
+    if (!_geometry || _culled_draws.empty())
+      return;
+
+    if (!_compaction_pipeline)
+    {
+      _compaction_shader.emplace(shader_type::compute, compaction_shader_source());
+      _compaction_pipeline.emplace();
+      (*_compaction_pipeline)->use(*_compaction_shader);
+    }
+
+    auto const draw_count = std::uint32_t(_culled_draws.size());
+    if (_culled_dirty)
+    {
+      _culled_buffer->load(std::span(_culled_draws));
+      if (_compacted_buffer->size() < draw_count * sizeof(draw_info_indexed))
+        _compacted_buffer->load(nullptr, draw_count * sizeof(draw_info_indexed));
+      _culled_dirty = false;
+    }
+
+    compaction_parameters const parameters{
+      .planes = frustum.planes,
+      .draw_count = draw_count,
+      .padding = {}
+    };
+    std::uint32_t const visible_count = 0;
+    _compaction_parameter_buffer->load(std::span(&parameters, 1));
+    _draw_count_buffer->load(std::span(&visible_count, 1));
+
+    _culled_buffer->bind(state, compaction_binding + 0);
+    _compaction_parameter_buffer->bind(state, compaction_binding + 1);
+    _compacted_buffer->bind(state, compaction_binding + 2);
+    _draw_count_buffer->bind(state, compaction_binding + 3);
+    (*_compaction_pipeline)->dispatch(state, (draw_count + compaction_group_size - 1) / compaction_group_size);
+
+    // The dispatch left the compaction pipeline bound.
+    pipeline->bind(state);
+    _geometry->get().use_buffer(state, 0, _vertex_buffer);
+    _geometry->get().use_index_buffer(state, _index_size.value(), _index_buffer);
+    _geometry->get().draw_indexed(state, primitive, _compacted_buffer, _draw_count_buffer, draw_count);
+  }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "graphics.hpp"
+#include "draw_compaction.hpp"
+#include <array>
 #include <vector>
 #include <span>
 #include <stdexcept>
@@ -20,6 +22,61 @@ namespace goop
 
     template<typename T, std::integral I>
     draw_info_indexed append_data(std::span<T> data, std::span<I> indices)
+    {
+      set_index_type<I>();
+
+      draw_info_indexed info{
+        .count = std::uint32_t(indices.size()),
+        .instance_count = 1,
+        .first_index = std::uint32_t(_index_count),
+        .base_vertex = std::uint32_t(_vertex_count),
+        .base_instance = 0
+      };
+      _vertex_buffer->load(data, _vertex_count * sizeof(T));
+      _index_buffer->load(indices, _index_count * sizeof(I));
+      _vertex_count += data.size();
+      _index_count += indices.size();
+      return info;
+    }
+
+    // Overwrite a range of previously uploaded vertices or indices, given as element offsets. The buffers grow
+    // geometrically to fit, so that repeated appends at the end don't copy the whole buffer every time.
+    template<typename T>
+    void update_vertices(std::span<T> data, std::size_t first_vertex)
+    {
+      reserve(_vertex_buffer, (first_vertex + data.size()) * sizeof(T));
+      _vertex_buffer->load(data, first_vertex * sizeof(T));
+    }
+
+    template<std::integral I>
+    void update_indices(std::span<I> indices, std::size_t first_index)
+    {
+      set_index_type<I>();
+      reserve(_index_buffer, (first_index + indices.size()) * sizeof(I));
+      _index_buffer->load(indices, first_index * sizeof(I));
+    }
+
+    void clear_queue();
+    void enqueue(draw_info_indexed const& info);
+    void draw(draw_state_base& state, primitive_type primitive);
+
+    // Culled draws are kept in a persistent buffer together with their bounds and are only uploaded when they change.
+    // draw_culled compacts the visible ones into an indirect buffer on the GPU, see compact_draws for the CPU reference,
+    // and draws them with pipeline and the count written by that pass. Removed ids are reused by later additions and cannot be
+    // updated or removed until then.
+    std::uint32_t add_culled(draw_info_indexed const& info, rnu::vec3 min, rnu::vec3 max);
+    void update_culled(std::uint32_t id, draw_info_indexed const& info, rnu::vec3 min, rnu::vec3 max);
+    void remove_culled(std::uint32_t id);
+    void clear_culled();
+    std::span<culled_draw const> culled_draws() const;
+    void draw_culled(draw_state_base& state, shader_pipeline& pipeline, primitive_type primitive, frustum const& frustum);
+
+    // The compaction pass uses the shader storage bindings from here up to compaction_binding + 3.
+    static constexpr std::uint32_t compaction_binding = 4;
+
+  private:
+    template<std::integral I>
+    void set_index_type()
     {
       auto const index_type = [&] {
         switch (sizeof(I))
@@ -41,26 +98,17 @@ namespace goop
         throw std::invalid_argument("Index type is different from previously set one.");
 
       _index_size = index_type;
-
-      draw_info_indexed info{
-        .count = std::uint32_t(indices.size()),
-        .instance_count = 1,
-        .first_index = std::uint32_t(_index_count),
-        .base_vertex = std::uint32_t(_vertex_count),
-        .base_instance = 0
-      };
-      _vertex_buffer->load(data, _vertex_count * sizeof(T));
-      _index_buffer->load(indices, _index_count * sizeof(I));
-      _vertex_count += data.size();
-      _index_count += indices.size();
-      return info;
     }
 
-    void clear_queue();
-    void enqueue(draw_info_indexed const& info);
-    void draw(draw_state_base& state, primitive_type primitive);
+    static void reserve(buffer& target, std::size_t bytes);
+
+    struct compaction_parameters
+    {
+      std::array<rnu::vec4, 6> planes;
+      std::uint32_t draw_count;
+      std::uint32_t padding[3];
+    };
 
-  private:
     std::optional<attribute_format::bit_width> _index_size;
     std::optional<handle_ref<geometry_format_base>> _geometry;
     buffer _vertex_buffer;
@@ -71,6 +119,16 @@ namespace goop
     std::size_t _previous_hash = 0;
     std::size_t _current_hash = 0;
     std::vector<draw_info_indexed> _draw_commands;
+
+    bool _culled_dirty = false;
+    std::vector<culled_draw> _culled_draws;
+    std::vector<std::uint32_t> _free_culled;
+    buffer _culled_buffer;
+    buffer _compacted_buffer;
+    buffer _compaction_parameter_buffer;
+    buffer _draw_count_buffer;
+    std::optional<shader> _compaction_shader;
+    std::optional<shader_pipeline> _compaction_pipeline;
   };
 
   using multi_draw = handle<multi_draw_base, multi_draw_base>;
@@ -18,6 +18,11 @@ namespace goop::opengl
     return size;
   }
 
+  void buffer::bind(draw_state_base& state, std::uint32_t binding) const
+  {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, handle());
+  }
+
   void buffer::load_impl(std::byte const* data, std::size_t data_size, std::ptrdiff_t offset)
   {
     if (!glIsBuffer(handle()))
@@ -9,6 +9,7 @@ namespace goop::opengl
   public:
     ~buffer();
     std::size_t size() const override;
+    void bind(draw_state_base& state, std::uint32_t binding) const override;
     void load_impl(std::byte const* data, std::size_t data_size, std::ptrdiff_t offset = 0) override;
   };
 }
\ No newline at end of file
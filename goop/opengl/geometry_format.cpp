@@ -148,6 +148,19 @@ namespace goop::opengl
     glMultiDrawElementsIndirect(determine_mode(type), _index_type, offset_ptr, count, sizeof(draw_info_indexed));
     glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
   }
+  void geometry_format::draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, buffer_base const& count_buffer, std::size_t max_count, std::ptrdiff_t offset, std::ptrdiff_t count_offset)
+  {
+    glBindVertexArray(handle());
+    auto const buf = static_cast<buffer const&>(indirect_buffer).handle();
+    auto const count_buf = static_cast<buffer const&>(count_buffer).handle();
+    void const* offset_ptr = nullptr;
+    std::memcpy(&offset_ptr, &offset, sizeof(offset));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buf);
+    glBindBuffer(GL_PARAMETER_BUFFER, count_buf);
+    glMultiDrawElementsIndirectCount(determine_mode(type), _index_type, offset_ptr, count_offset, max_count, sizeof(draw_info_indexed));
+    glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  }
   void geometry_format::draw_array(draw_state_base& state, primitive_type type, draw_info_array const& info)
   {
     glBindVertexArray(handle());
@@ -19,6 +19,7 @@ namespace goop::opengl
     void set_binding(std::size_t binding, std::size_t stride, attribute_repetition repeat) override;
     void draw_indexed(draw_state_base& state, primitive_type type, draw_info_indexed const& info) override;
     void draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset = 0) override;
+    void draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, buffer_base const& count_buffer, std::size_t max_count, std::ptrdiff_t offset = 0, std::ptrdiff_t count_offset = 0) override;
     void draw_array(draw_state_base& state, primitive_type type, draw_info_array const& info) override;
     void draw_array(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset = 0) override;
 
@@ -0,0 +1,70 @@
+#include "ring_buffer.hpp"
+#include <stdexcept>
+
+namespace goop::opengl
+{
+  ring_buffer::~ring_buffer()
+  {
+    release();
+  }
+
+  void ring_buffer::bind(draw_state_base& state, std::uint32_t binding, ring_allocation const& allocation) const
+  {
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, handle(), allocation.offset, allocation.data.size());
+  }
+
+  std::byte* ring_buffer::create_storage(std::size_t capacity)
+  {
+    release();
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &handle());
+    glNamedBufferStorage(handle(), capacity, nullptr, flags);
+    return static_cast<std::byte*>(glMapNamedBufferRange(handle(), 0, capacity, flags));
+  }
+
+  void ring_buffer::insert_fence(std::uint64_t frame)
+  {
+    _fences.emplace_back(frame, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  }
+
+  bool ring_buffer::wait_fence(std::uint64_t frame, bool block)
+  {
+    while (!_fences.empty() && _fences.front().first <= frame)
+    {
+      auto const fence = _fences.front().second;
+      auto const result = glClientWaitSync(fence, block ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, block ? GLuint64(1'000'000'000) : 0);
+      if (result == GL_WAIT_FAILED)
+        throw std::runtime_error("Waiting for a ring buffer fence failed.");
+      if (result == GL_TIMEOUT_EXPIRED)
+      {
+        if (block)
+          continue;
+        return false;
+      }
+
+      glDeleteSync(fence);
+      _fences.pop_front();
+    }
+    return true;
+  }
+
+  void ring_buffer::flush(ring_allocation const& allocation)
+  {
+    // The storage is mapped coherently, writes reach the GPU without an explicit flush.
+  }
+
+  void ring_buffer::release()
+  {
+    for (auto const& [frame, fence] : _fences)
+      glDeleteSync(fence);
+    _fences.clear();
+
+    if (glIsBuffer && glDeleteBuffers && glIsBuffer(handle()))
+    {
+      glUnmapNamedBuffer(handle());
+      glDeleteBuffers(1, &handle());
+    }
+    handle() = 0;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include <deque>
+#include <glad/glad.h>
+#include "../generic/ring_buffer.hpp"
+#include "handle.hpp"
+
+namespace goop::opengl
+{
+  class ring_buffer : public ring_buffer_base, public single_handle
+  {
+  public:
+    ~ring_buffer();
+
+    void bind(draw_state_base& state, std::uint32_t binding, ring_allocation const& allocation) const override;
+
+  protected:
+    std::byte* create_storage(std::size_t capacity) override;
+    void insert_fence(std::uint64_t frame) override;
+    bool wait_fence(std::uint64_t frame, bool block) override;
+    void flush(ring_allocation const& allocation) override;
+
+  private:
+    void release();
+
+    std::deque<std::pair<std::uint64_t, GLsync>> _fences;
+  };
+}
\ No newline at end of file
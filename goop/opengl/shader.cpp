@@ -102,6 +102,13 @@ namespace goop::opengl
     glBindProgramPipeline(handle());
   }
 
+  void shader_pipeline::dispatch(draw_state_base& state, std::uint32_t groups_x, std::uint32_t groups_y, std::uint32_t groups_z)
+  {
+    glBindProgramPipeline(handle());
+    glDispatchCompute(groups_x, groups_y, groups_z);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+  }
+
   shader_pipeline::~shader_pipeline()
   {
     if (glDeleteProgramPipelines && glIsProgramPipeline && glIsProgramPipeline(handle()))
@@ -37,5 +37,6 @@ namespace goop::opengl
     // Inherited via shader_pipeline_base
     virtual void use(shader_base const& shader) override;
     virtual void bind(draw_state_base& state) override;
+    virtual void dispatch(draw_state_base& state, std::uint32_t groups_x, std::uint32_t groups_y = 1, std::uint32_t groups_z = 1) override;
   };
 }
\ No newline at end of file
@@ -117,7 +117,9 @@ namespace goop::opengl
     }
     else
     {
-      glTextureStorage3D(handle(), mipmap_levels, get_data_type(data), w, h, d);
+      // Layers of array textures are not mipmapped along their depth.
+      auto const mip_depth = type == texture_type::t3d ? d : 1;
+      glTextureStorage3D(handle(), mipmap_levels == 0 ? num_mipmaps(w, h, mip_depth) : mipmap_levels, get_data_type(data), w, h, d);
     }
   }
 
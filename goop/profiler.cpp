@@ -0,0 +1,154 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+
+namespace goop
+{
+  namespace
+  {
+    thread_local std::uint32_t zone_depth = 0;
+  }
+
+  profiler& profiler::instance()
+  {
+    static profiler p;
+    return p;
+  }
+
+  std::uint64_t profiler::now()
+  {
+    static auto const epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+  }
+
+  void profiler::set_enabled(bool enabled)
+  {
+    _enabled = enabled;
+  }
+
+  bool profiler::enabled() const
+  {
+    return _enabled;
+  }
+
+  void profiler::set_retained_frames(std::size_t frames)
+  {
+    std::unique_lock lock(_mutex);
+    _retained_frames = frames;
+    while (_history.size() > _retained_frames)
+      _history.pop_front();
+  }
+
+  frame_profile profiler::end_frame()
+  {
+    auto const end = now();
+
+    std::unique_lock lock(_mutex);
+    frame_profile result{ .frame = _frame++, .begin_ns = _frame_begin, .end_ns = end, .zones = {}, .dropped_events = 0 };
+    _frame_begin = end;
+
+    std::vector<zone_event> events;
+    for (auto const& buffer : _threads)
+    {
+      auto const head = buffer->head.load(std::memory_order_acquire);
+      auto tail = buffer->tail.load(std::memory_order_relaxed);
+      for (; tail != head; ++tail)
+        events.push_back(buffer->events[tail % thread_buffer_size]);
+      buffer->tail.store(tail, std::memory_order_release);
+      result.dropped_events += buffer->dropped.exchange(0);
+    }
+
+    std::unordered_map<std::string_view, zone_stats> zones;
+    for (auto const& event : events)
+    {
+      auto& stats = zones.try_emplace(event.name, zone_stats{ .name = event.name, .calls = 0, .total_ns = 0, .max_ns = 0 }).first->second;
+      auto const duration = event.end_ns - event.begin_ns;
+      ++stats.calls;
+      stats.total_ns += duration;
+      stats.max_ns = std::max(stats.max_ns, duration);
+    }
+    for (auto const& [name, stats] : zones)
+      result.zones.push_back(stats);
+    std::sort(result.zones.begin(), result.zones.end(), [](zone_stats const& lhs, zone_stats const& rhs) { return lhs.total_ns > rhs.total_ns; });
+
+    if (_retained_frames != 0)
+    {
+      _history.push_back(std::move(events));
+      while (_history.size() > _retained_frames)
+        _history.pop_front();
+    }
+    return result;
+  }
+
+  void profiler::write_chrome_trace(std::ostream& stream) const
+  {
+    std::unique_lock lock(_mutex);
+
+    // Complete events ("ph": "X") carry their duration, timestamps are in microseconds.
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    for (auto const& frame : _history)
+    {
+      for (auto const& event : frame)
+      {
+        if (!std::exchange(first, false))
+          stream << ',';
+        stream << "\n{\"name\":\"" << event.name << "\",\"cat\":\"goop\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+          << ",\"ts\":" << event.begin_ns / 1000.0 << ",\"dur\":" << (event.end_ns - event.begin_ns) / 1000.0 << '}';
+      }
+    }
+    stream << "\n]}\n";
+  }
+
+  void profiler::record(zone_event const& event)
+  {
+    auto& buffer = local_buffer();
+    auto const head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= thread_buffer_size)
+    {
+      ++buffer.dropped;
+      return;
+    }
+
+    auto& slot = buffer.events[head % thread_buffer_size];
+    slot = event;
+    slot.thread = buffer.thread;
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+
+  profiler::thread_buffer& profiler::local_buffer()
+  {
+    // The profiler keeps the buffer alive after its thread exits, so that its last events are still collected.
+    thread_local std::shared_ptr<thread_buffer> buffer = [this] {
+      auto b = std::make_shared<thread_buffer>();
+      std::unique_lock lock(_mutex);
+      b->thread = std::uint32_t(_threads.size());
+      _threads.push_back(b);
+      return b;
+    }();
+    return *buffer;
+  }
+
+  scoped_zone::scoped_zone(char const* name)
+    : _name(name), _begin(0), _active(profiler::instance().enabled())
+  {
+    if (!_active)
+      return;
+
+    ++zone_depth;
+    _begin = profiler::now();
+  }
+
+  scoped_zone::~scoped_zone()
+  {
+    if (!_active)
+      return;
+
+    auto const end = profiler::now();
+    --zone_depth;
+    profiler::instance().record(zone_event{ .name = _name, .begin_ns = _begin, .end_ns = end, .depth = zone_depth, .thread = 0 });
+  }
+}
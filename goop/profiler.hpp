@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace goop
+{
+  struct zone_event
+  {
+    // Zone names have to outlive the profiler, they are expected to be string literals.
+    char const* name;
+    std::uint64_t begin_ns;
+    std::uint64_t end_ns;
+    std::uint32_t depth;
+    std::uint32_t thread;
+  };
+
+  struct zone_stats
+  {
+    std::string_view name;
+    std::size_t calls;
+    std::uint64_t total_ns;
+    std::uint64_t max_ns;
+  };
+
+  struct frame_profile
+  {
+    std::uint64_t frame = 0;
+    std::uint64_t begin_ns = 0;
+    std::uint64_t end_ns = 0;
+    // Sorted by descending total time.
+    std::vector<zone_stats> zones;
+    // Events lost because a thread recorded more than its buffer holds within one frame.
+    std::size_t dropped_events = 0;
+  };
+
+  // Collects nested, scoped zones from any thread. Each thread writes into its own fixed size ring buffer without locking,
+  // end_frame drains all of them, aggregates the zones per frame and keeps the events of the most recent frames for export.
+  class profiler
+  {
+  public:
+    static constexpr std::size_t thread_buffer_size = 4096;
+
+    static profiler& instance();
+
+    // Nanoseconds since the profiler was first used.
+    static std::uint64_t now();
+
+    void set_enabled(bool enabled);
+    bool enabled() const;
+    void set_retained_frames(std::size_t frames);
+
+    frame_profile end_frame();
+
+    // Writes the retained events in the Chrome trace event format, which chrome://tracing and Perfetto can open.
+    void write_chrome_trace(std::ostream& stream) const;
+
+    void record(zone_event const& event);
+
+  private:
+    struct thread_buffer
+    {
+      std::uint32_t thread;
+      std::array<zone_event, thread_buffer_size> events;
+      std::atomic_uint64_t head = 0;
+      std::atomic_uint64_t tail = 0;
+      std::atomic_size_t dropped = 0;
+    };
+
+    thread_buffer& local_buffer();
+
+    std::atomic_bool _enabled = true;
+    mutable std::mutex _mutex;
+    std::vector<std::shared_ptr<thread_buffer>> _threads;
+    std::deque<std::vector<zone_event>> _history;
+    std::size_t _retained_frames = 120;
+    std::uint64_t _frame = 0;
+    std::uint64_t _frame_begin = 0;
+  };
+
+  class scoped_zone
+  {
+  public:
+    explicit scoped_zone(char const* name);
+    ~scoped_zone();
+    scoped_zone(scoped_zone const&) = delete;
+    scoped_zone& operator=(scoped_zone const&) = delete;
+
+  private:
+    char const* _name;
+    std::uint64_t _begin;
+    bool _active;
+  };
+}
+
+#define GOOP_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GOOP_PROFILE_CONCAT(a, b) GOOP_PROFILE_CONCAT_IMPL(a, b)
+#define GOOP_PROFILE_ZONE(name) ::goop::scoped_zone GOOP_PROFILE_CONCAT(goop_profile_zone_, __LINE__)(name)
@@ -0,0 +1,35 @@
+#include "buffer.hpp"
+#include <algorithm>
+
+namespace goop::recording
+{
+  std::size_t buffer::size() const
+  {
+    return _data.size();
+  }
+
+  void buffer::bind(draw_state_base& state, std::uint32_t binding) const
+  {
+    recorded_commands().record(command{ .type = command_type::buffer_bind, .object = id(), .binding = binding });
+  }
+
+  void buffer::load_impl(std::byte const* data, std::size_t data_size, std::ptrdiff_t offset)
+  {
+    // Like the OpenGL buffer, growing only keeps the contents before offset.
+    if (_data.size() < data_size + offset)
+    {
+      std::vector<std::byte> grown(data_size + offset);
+      std::copy_n(_data.begin(), std::min<std::size_t>(offset, _data.size()), grown.begin());
+      _data = std::move(grown);
+    }
+
+    if (data)
+      std::copy_n(data, data_size, std::next(_data.begin(), offset));
+    recorded_commands().record(command{ .type = command_type::buffer_load, .object = id(), .bytes = data ? data_size : 0 });
+  }
+
+  std::span<std::byte const> buffer::data() const
+  {
+    return _data;
+  }
+}
\ No newline at end of file
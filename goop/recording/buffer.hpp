@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+#include "../generic/buffer.hpp"
+#include "command_list.hpp"
+
+namespace goop::recording
+{
+  class buffer : public buffer_base, public recorded_object
+  {
+  public:
+    std::size_t size() const override;
+    void bind(draw_state_base& state, std::uint32_t binding) const override;
+    void load_impl(std::byte const* data, std::size_t data_size, std::ptrdiff_t offset = 0) override;
+
+    // The contents as they would be on the GPU, indirect draws read their commands from here.
+    std::span<std::byte const> data() const;
+
+  private:
+    std::vector<std::byte> _data;
+  };
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "command_list.hpp"
+#include <algorithm>
+#include <atomic>
+
+namespace goop::recording
+{
+  void command_list::record(command const& c)
+  {
+    std::unique_lock lock(_mutex);
+    _commands.push_back(c);
+  }
+
+  void command_list::clear()
+  {
+    std::unique_lock lock(_mutex);
+    _commands.clear();
+  }
+
+  std::vector<command> command_list::commands() const
+  {
+    std::unique_lock lock(_mutex);
+    return _commands;
+  }
+
+  std::size_t command_list::count(command_type type) const
+  {
+    std::unique_lock lock(_mutex);
+    return std::count_if(_commands.begin(), _commands.end(), [&](command const& c) { return c.type == type; });
+  }
+
+  std::size_t command_list::bytes_uploaded() const
+  {
+    std::unique_lock lock(_mutex);
+    std::size_t bytes = 0;
+    for (auto const& c : _commands)
+      bytes += c.bytes;
+    return bytes;
+  }
+
+  std::size_t command_list::draw_calls() const
+  {
+    std::unique_lock lock(_mutex);
+    return std::count_if(_commands.begin(), _commands.end(), [](command const& c) {
+      return c.type == command_type::draw_indexed || c.type == command_type::draw_indexed_indirect ||
+        c.type == command_type::draw_array || c.type == command_type::draw_array_indirect;
+      });
+  }
+
+  command_list& recorded_commands()
+  {
+    static command_list commands;
+    return commands;
+  }
+
+  recorded_object::recorded_object()
+  {
+    static std::atomic_uint64_t next_id = 1;
+    _id = next_id++;
+  }
+
+  std::uint64_t recorded_object::id() const
+  {
+    return _id;
+  }
+}
\ No newline at end of file
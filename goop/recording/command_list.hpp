@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace goop::recording
+{
+  enum class command_type
+  {
+    buffer_load,
+    buffer_bind,
+    mapped_buffer_allocate,
+    mapped_buffer_flush,
+    mapped_buffer_bind,
+    ring_buffer_write,
+    ring_buffer_bind,
+    texture_allocate,
+    texture_load,
+    texture_generate_mipmaps,
+    texture_bind,
+    sampler_bind,
+    shader_compile,
+    pipeline_bind,
+    dispatch,
+    render_target_attach,
+    render_target_activate,
+    render_target_clear,
+    render_target_deactivate,
+    use_vertex_buffer,
+    use_index_buffer,
+    draw_indexed,
+    draw_indexed_indirect,
+    draw_array,
+    draw_array_indirect,
+    set_viewport,
+    set_scissor,
+    set_depth_test,
+    set_culling_mode,
+    set_blending,
+    display
+  };
+
+  struct command
+  {
+    command_type type;
+    // Id of the recorded object the command works on, see recorded_object.
+    std::uint64_t object = 0;
+    // Bytes transferred from the CPU to the object.
+    std::size_t bytes = 0;
+    std::uint32_t binding = 0;
+    // Number of draws or work groups.
+    std::size_t count = 0;
+    // Indices or vertices drawn, summed over all draws and instances.
+    std::size_t elements = 0;
+  };
+
+  // Every call into the recording backend appends a command here instead of talking to a GPU.
+  class command_list
+  {
+  public:
+    void record(command const& c);
+    void clear();
+
+    std::vector<command> commands() const;
+    std::size_t count(command_type type) const;
+    std::size_t bytes_uploaded() const;
+    std::size_t draw_calls() const;
+
+  private:
+    mutable std::mutex _mutex;
+    std::vector<command> _commands;
+  };
+
+  // All recording objects share one command list, so that uploads made outside of a draw state are captured as well.
+  command_list& recorded_commands();
+
+  // Gives every recording object a unique id, which is what commands refer to.
+  class recorded_object
+  {
+  public:
+    recorded_object();
+    recorded_object(recorded_object const&) = delete;
+    recorded_object& operator=(recorded_object const&) = delete;
+
+    std::uint64_t id() const;
+
+  private:
+    std::uint64_t _id;
+  };
+}
\ No newline at end of file
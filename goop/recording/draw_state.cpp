@@ -0,0 +1,62 @@
+#include "draw_state.hpp"
+#include "render_target.hpp"
+
+namespace goop::recording
+{
+  void draw_state::from_window(GLFWwindow* window)
+  {
+    _window = window;
+  }
+
+  std::pair<int, int> draw_state::current_surface_size() const
+  {
+    if (!_window)
+      return _surface_size;
+
+    std::pair<int, int> size;
+    glfwGetFramebufferSize(_window, &size.first, &size.second);
+    return size;
+  }
+
+  int draw_state::display(render_target_base const& source, int source_width, int source_height)
+  {
+    auto const& recorded_source = dynamic_cast<render_target const&>(source);
+    recorded_commands().record(command{ .type = command_type::display, .object = recorded_source.id() });
+    return _image = (_image + 1) % 2;
+  }
+
+  void draw_state::set_depth_test(bool enabled)
+  {
+    recorded_commands().record(command{ .type = command_type::set_depth_test, .object = id() });
+  }
+
+  void draw_state::set_viewport(rnu::rect2f viewport)
+  {
+    recorded_commands().record(command{ .type = command_type::set_viewport, .object = id() });
+  }
+
+  void draw_state::set_scissor(std::optional<rnu::rect2f> scissor)
+  {
+    recorded_commands().record(command{ .type = command_type::set_scissor, .object = id() });
+  }
+
+  void draw_state::set_culling_mode(culling_mode mode)
+  {
+    recorded_commands().record(command{ .type = command_type::set_culling_mode, .object = id() });
+  }
+
+  void draw_state::set_blending(blending_mode const& blending)
+  {
+    recorded_commands().record(command{ .type = command_type::set_blending, .object = id() });
+  }
+
+  void draw_state::set_blending(std::nullopt_t)
+  {
+    recorded_commands().record(command{ .type = command_type::set_blending, .object = id() });
+  }
+
+  void draw_state::set_surface_size(int width, int height)
+  {
+    _surface_size = { width, height };
+  }
+}
\ No newline at end of file
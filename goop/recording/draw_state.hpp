@@ -0,0 +1,28 @@
+#pragma once
+#include "../generic/draw_state.hpp"
+#include "command_list.hpp"
+
+namespace goop::recording
+{
+  // Without a window the surface has the size given to set_surface_size.
+  class draw_state : public draw_state_base, public recorded_object
+  {
+  public:
+    void from_window(GLFWwindow* window) override;
+    std::pair<int, int> current_surface_size() const override;
+    int display(render_target_base const& source, int source_width, int source_height) override;
+    void set_depth_test(bool enabled) override;
+    void set_viewport(rnu::rect2f viewport) override;
+    void set_scissor(std::optional<rnu::rect2f> scissor) override;
+    void set_culling_mode(culling_mode mode) override;
+    void set_blending(blending_mode const& blending) override;
+    void set_blending(std::nullopt_t) override;
+
+    void set_surface_size(int width, int height);
+
+  private:
+    int _image = 0;
+    GLFWwindow* _window = nullptr;
+    std::pair<int, int> _surface_size{ 1, 1 };
+  };
+}
\ No newline at end of file
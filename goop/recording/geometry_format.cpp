@@ -0,0 +1,78 @@
+#include "geometry_format.hpp"
+#include "buffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace goop::recording
+{
+  template<typename Info>
+  static std::size_t indirect_elements(buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset)
+  {
+    auto const data = dynamic_cast<buffer const&>(indirect_buffer).data();
+    std::size_t elements = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      auto const at = offset + i * sizeof(Info);
+      if (at + sizeof(Info) > data.size())
+        break;
+
+      Info info;
+      std::memcpy(&info, data.data() + at, sizeof(Info));
+      elements += std::size_t(info.count) * info.instance_count;
+    }
+    return elements;
+  }
+
+  void geometry_format::set_attribute(std::size_t index, std::optional<attribute> attr)
+  {
+  }
+
+  void geometry_format::use_index_buffer(draw_state_base& state, attribute_format::bit_width bits, handle_ref<buffer_base> buffer)
+  {
+    recorded_commands().record(command{ .type = command_type::use_index_buffer, .object = buffer.as<recording::buffer>()->id() });
+  }
+
+  void geometry_format::use_buffer(draw_state_base& state, std::size_t binding, handle_ref<buffer_base> buffer, std::ptrdiff_t offset)
+  {
+    recorded_commands().record(command{ .type = command_type::use_vertex_buffer, .object = buffer.as<recording::buffer>()->id(), .binding = std::uint32_t(binding) });
+  }
+
+  void geometry_format::set_binding(std::size_t binding, std::size_t stride, attribute_repetition repeat)
+  {
+  }
+
+  void geometry_format::draw_indexed(draw_state_base& state, primitive_type type, draw_info_indexed const& info)
+  {
+    recorded_commands().record(command{ .type = command_type::draw_indexed, .object = id(), .count = 1, .elements = std::size_t(info.count) * info.instance_count });
+  }
+
+  void geometry_format::draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset)
+  {
+    recorded_commands().record(command{ .type = command_type::draw_indexed_indirect, .object = id(), .count = count,
+      .elements = indirect_elements<draw_info_indexed>(indirect_buffer, count, offset) });
+  }
+
+  void geometry_format::draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, buffer_base const& count_buffer, std::size_t max_count, std::ptrdiff_t offset, std::ptrdiff_t count_offset)
+  {
+    // Whatever was last uploaded to the count buffer is used, compute shaders writing it are not executed.
+    auto const counts = dynamic_cast<buffer const&>(count_buffer).data();
+    std::uint32_t count = 0;
+    if (count_offset + sizeof(count) <= counts.size())
+      std::memcpy(&count, counts.data() + count_offset, sizeof(count));
+    auto const draws = std::min<std::size_t>(count, max_count);
+
+    recorded_commands().record(command{ .type = command_type::draw_indexed_indirect, .object = id(), .count = draws,
+      .elements = indirect_elements<draw_info_indexed>(indirect_buffer, draws, offset) });
+  }
+
+  void geometry_format::draw_array(draw_state_base& state, primitive_type type, draw_info_array const& info)
+  {
+    recorded_commands().record(command{ .type = command_type::draw_array, .object = id(), .count = 1, .elements = std::size_t(info.count) * info.instance_count });
+  }
+
+  void geometry_format::draw_array(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset)
+  {
+    recorded_commands().record(command{ .type = command_type::draw_array_indirect, .object = id(), .count = count,
+      .elements = indirect_elements<draw_info_array>(indirect_buffer, count, offset) });
+  }
+}
\ No newline at end of file
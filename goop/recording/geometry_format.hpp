@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../generic/geometry_format.hpp"
+#include "command_list.hpp"
+
+namespace goop::recording
+{
+  // Indirect draws read their commands from recording buffers, so the recorded element counts match what the GPU would draw.
+  class geometry_format : public geometry_format_base, public recorded_object
+  {
+  public:
+    void set_attribute(std::size_t index, std::optional<attribute> attr) override;
+    void use_index_buffer(draw_state_base& state, attribute_format::bit_width bits, handle_ref<buffer_base> buffer) override;
+    void use_buffer(draw_state_base& state, std::size_t binding, handle_ref<buffer_base> buffer, std::ptrdiff_t offset) override;
+    void set_binding(std::size_t binding, std::size_t stride, attribute_repetition repeat) override;
+    void draw_indexed(draw_state_base& state, primitive_type type, draw_info_indexed const& info) override;
+    void draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset = 0) override;
+    void draw_indexed(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, buffer_base const& count_buffer, std::size_t max_count, std::ptrdiff_t offset = 0, std::ptrdiff_t count_offset = 0) override;
+    void draw_array(draw_state_base& state, primitive_type type, draw_info_array const& info) override;
+    void draw_array(draw_state_base& state, primitive_type type, buffer_base const& indirect_buffer, std::size_t count, std::ptrdiff_t offset = 0) override;
+  };
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "draw_state.hpp"
+#include "../generic/mapped_buffer.hpp"
+#include "command_list.hpp"
+
+namespace goop::recording
+{
+  template<typename T>
+  class mapped_buffer : public mapped_buffer_base<T>, public recorded_object
+  {
+  public:
+    virtual void allocate(std::size_t elements) override;
+    virtual void map() override;
+    virtual void unmap() override;
+    virtual void flush() override;
+    virtual void bind(draw_state_base& state, std::uint32_t binding) const override;
+
+  private:
+    std::vector<T> _data;
+  };
+
+  template<typename T>
+  inline void mapped_buffer<T>::allocate(std::size_t elements)
+  {
+    mapped_buffer_base<T>::_size = elements;
+    if (mapped_buffer_base<T>::_capacity >= elements)
+      return;
+
+    _data.resize(elements);
+    mapped_buffer_base<T>::_capacity = elements;
+    recorded_commands().record(command{ .type = command_type::mapped_buffer_allocate, .object = id(), .count = elements });
+  }
+
+  template<typename T>
+  void mapped_buffer<T>::map()
+  {
+    mapped_buffer_base<T>::_mapped_ptr = _data.data();
+  }
+
+  template<typename T>
+  void mapped_buffer<T>::unmap()
+  {
+    mapped_buffer_base<T>::_mapped_ptr = nullptr;
+  }
+
+  template<typename T>
+  void mapped_buffer<T>::flush()
+  {
+    recorded_commands().record(command{ .type = command_type::mapped_buffer_flush, .object = id(), .bytes = mapped_buffer_base<T>::size_bytes() });
+  }
+
+  template<typename T>
+  void mapped_buffer<T>::bind(draw_state_base& state, std::uint32_t binding) const
+  {
+    recorded_commands().record(command{ .type = command_type::mapped_buffer_bind, .object = id(), .binding = binding });
+  }
+}
@@ -0,0 +1,44 @@
+#include "render_target.hpp"
+
+namespace goop::recording
+{
+  void render_target::bind_texture(int binding_point, texture_base const& texture, int level)
+  {
+    recorded_commands().record(command{ .type = command_type::render_target_attach, .object = id(), .binding = std::uint32_t(binding_point) });
+  }
+
+  void render_target::bind_depth_stencil_texture(texture_base const& texture, int level)
+  {
+    recorded_commands().record(command{ .type = command_type::render_target_attach, .object = id() });
+  }
+
+  void render_target::bind_texture_layer(int binding_point, texture_base const& texture, int level, int layer)
+  {
+    bind_texture(binding_point, texture, level);
+  }
+
+  void render_target::bind_depth_stencil_texture_layer(texture_base const& texture, int level, int layer)
+  {
+    bind_depth_stencil_texture(texture, level);
+  }
+
+  void render_target::activate(draw_state_base& state)
+  {
+    recorded_commands().record(command{ .type = command_type::render_target_activate, .object = id() });
+  }
+
+  void render_target::clear_color(int binding_point, std::span<float const, 4> color)
+  {
+    recorded_commands().record(command{ .type = command_type::render_target_clear, .object = id(), .binding = std::uint32_t(binding_point) });
+  }
+
+  void render_target::clear_depth_stencil(float depth, int stencil)
+  {
+    recorded_commands().record(command{ .type = command_type::render_target_clear, .object = id() });
+  }
+
+  void render_target::deactivate(draw_state_base& state)
+  {
+    recorded_commands().record(command{ .type = command_type::render_target_deactivate, .object = id() });
+  }
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "ring_buffer.hpp"
+
+namespace goop::recording
+{
+  void ring_buffer::bind(draw_state_base& state, std::uint32_t binding, ring_allocation const& allocation) const
+  {
+    recorded_commands().record(command{ .type = command_type::ring_buffer_bind, .object = id(), .binding = binding });
+  }
+
+  std::byte* ring_buffer::create_storage(std::size_t capacity)
+  {
+    _storage.assign(capacity, std::byte{});
+    return _storage.data();
+  }
+
+  void ring_buffer::insert_fence(std::uint64_t frame)
+  {
+  }
+
+  bool ring_buffer::wait_fence(std::uint64_t frame, bool block)
+  {
+    return true;
+  }
+
+  void ring_buffer::flush(ring_allocation const& allocation)
+  {
+    recorded_commands().record(command{ .type = command_type::ring_buffer_write, .object = id(), .bytes = allocation.data.size() });
+  }
+}
\ No newline at end of file
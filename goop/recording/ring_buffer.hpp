@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include "../generic/ring_buffer.hpp"
+#include "command_list.hpp"
+
+namespace goop::recording
+{
+  // There is no GPU to wait for, so frames are finished as soon as they end.
+  class ring_buffer : public ring_buffer_base, public recorded_object
+  {
+  public:
+    void bind(draw_state_base& state, std::uint32_t binding, ring_allocation const& allocation) const override;
+
+  protected:
+    std::byte* create_storage(std::size_t capacity) override;
+    void insert_fence(std::uint64_t frame) override;
+    bool wait_fence(std::uint64_t frame, bool block) override;
+    void flush(ring_allocation const& allocation) override;
+
+  private:
+    std::vector<std::byte> _storage;
+  };
+}
\ No newline at end of file
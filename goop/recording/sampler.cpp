@@ -0,0 +1,33 @@
+#include "sampler.hpp"
+
+namespace goop::recording
+{
+  void sampler::set_clamp(wrap_mode r, wrap_mode s, wrap_mode t)
+  {
+  }
+
+  void sampler::set_clamp(wrap_mode rst)
+  {
+  }
+
+  void sampler::set_mag_filter(sampler_filter filter)
+  {
+  }
+
+  void sampler::set_min_filter(sampler_filter filter, std::optional<sampler_filter> mipmap_filter)
+  {
+  }
+
+  void sampler::set_max_anisotropy(float a)
+  {
+  }
+
+  void sampler::bind(draw_state_base& state, std::uint32_t binding_point)
+  {
+    recorded_commands().record(command{ .type = command_type::sampler_bind, .object = id(), .binding = binding_point });
+  }
+
+  void sampler::set_compare_fun(compare cmp)
+  {
+  }
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../generic/sampler.hpp"
+#include "command_list.hpp"
+
+namespace goop::recording
+{
+  // Sampler parameters have no cost worth recording, only binding is captured.
+  class sampler : public sampler_base, public recorded_object
+  {
+  public:
+    virtual void set_clamp(wrap_mode r, wrap_mode s, wrap_mode t) override;
+    virtual void set_clamp(wrap_mode rst) override;
+    virtual void set_mag_filter(sampler_filter filter) override;
+    virtual void set_min_filter(sampler_filter filter, std::optional<sampler_filter> mipmap_filter = std::nullopt) override;
+    virtual void set_max_anisotropy(float a) override;
+    virtual void bind(draw_state_base& state, std::uint32_t binding_point) override;
+    virtual void set_compare_fun(compare cmp) override;
+  };
+}
\ No newline at end of file
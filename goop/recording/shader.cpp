@@ -0,0 +1,26 @@
+#include "shader.hpp"
+
+namespace goop::recording
+{
+  bool shader::compile_glsl(shader_type type, std::string_view source, std::string* info_log)
+  {
+    if (info_log)
+      info_log->clear();
+    recorded_commands().record(command{ .type = command_type::shader_compile, .object = id(), .bytes = source.size() });
+    return true;
+  }
+
+  void shader_pipeline::use(shader_base const& shader)
+  {
+  }
+
+  void shader_pipeline::bind(draw_state_base& state)
+  {
+    recorded_commands().record(command{ .type = command_type::pipeline_bind, .object = id() });
+  }
+
+  void shader_pipeline::dispatch(draw_state_base& state, std::uint32_t groups_x, std::uint32_t groups_y, std::uint32_t groups_z)
+  {
+    recorded_commands().record(command{ .type = command_type::dispatch, .object = id(), .count = std::size_t(groups_x) * groups_y * groups_z });
+  }
+}
\ No newline at end of file
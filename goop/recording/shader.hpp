@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../generic/shader.hpp"
+#include "command_list.hpp"
+
+namespace goop::recording
+{
+  // Sources are not compiled, every shader is accepted.
+  class shader : public shader_base, public recorded_object
+  {
+  protected:
+    virtual bool compile_glsl(shader_type type, std::string_view source, std::string* info_log = nullptr) override;
+  };
+
+  class shader_pipeline : public shader_pipeline_base, public recorded_object
+  {
+  public:
+    virtual void use(shader_base const& shader) override;
+    virtual void bind(draw_state_base& state) override;
+    virtual void dispatch(draw_state_base& state, std::uint32_t groups_x, std::uint32_t groups_y = 1, std::uint32_t groups_z = 1) override;
+  };
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "texture.hpp"
+
+namespace goop::recording
+{
+  void texture::allocate(texture_type type, data_type data, int w, int mipmap_levels)
+  {
+    allocate(type, data, w, 1, 1, mipmap_levels);
+  }
+
+  void texture::allocate(texture_type type, data_type data, int w, int h, int mipmap_levels)
+  {
+    allocate(type, data, w, h, 1, mipmap_levels);
+  }
+
+  void texture::allocate(texture_type type, data_type data, int w, int h, int d, int mipmap_levels)
+  {
+    _dimensions = { w, h, d };
+    recorded_commands().record(command{ .type = command_type::texture_allocate, .object = id() });
+  }
+
+  // Uploads are counted with the size of the client data they read, like the pixel transfer in OpenGL.
+  void texture::set_data(int level, int xoff, int w, int components, std::span<std::uint8_t const> pixel_data)
+  {
+    record_data(std::size_t(w) * components * sizeof(std::uint8_t));
+  }
+
+  void texture::set_data(int level, int xoff, int w, int components, std::span<float const> pixel_data)
+  {
+    record_data(std::size_t(w) * components * sizeof(float));
+  }
+
+  void texture::set_data(int level, int xoff, int yoff, int w, int h, int components, std::span<std::uint8_t const> pixel_data)
+  {
+    record_data(std::size_t(w) * h * components * sizeof(std::uint8_t));
+  }
+
+  void texture::set_data(int level, int xoff, int yoff, int w, int h, int components, std::span<float const> pixel_data)
+  {
+    record_data(std::size_t(w) * h * components * sizeof(float));
+  }
+
+  void texture::set_data(int level, int xoff, int yoff, int zoff, int w, int h, int d, int components, std::span<std::uint8_t const> pixel_data)
+  {
+    record_data(std::size_t(w) * h * d * components * sizeof(std::uint8_t));
+  }
+
+  void texture::set_data(int level, int xoff, int yoff, int zoff, int w, int h, int d, int components, std::span<float const> pixel_data)
+  {
+    record_data(std::size_t(w) * h * d * components * sizeof(float));
+  }
+
+  void texture::generate_mipmaps()
+  {
+    recorded_commands().record(command{ .type = command_type::texture_generate_mipmaps, .object = id() });
+  }
+
+  void texture::bind(draw_state_base& state, std::uint32_t binding_point) const
+  {
+    recorded_commands().record(command{ .type = command_type::texture_bind, .object = id(), .binding = binding_point });
+  }
+
+  rnu::vec3i texture::dimensions() const
+  {
+    return _dimensions;
+  }
+
+  void texture::record_data(std::size_t bytes)
+  {
+    recorded_commands().record(command{ .type = command_type::texture_load, .object = id(), .bytes = bytes });
+  }
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <ranges>
 #include <array>
 #include <cassert>
+#include <limits>
 
 namespace goop
 {
@@ -107,7 +108,12 @@ namespace goop
 
   ptr_reader font_accessor::begin_read() const
   {
-    return ptr_reader(std::visit([](auto& d) {return std::data(d); }, _file_data));
+    return ptr_reader(std::visit([](auto& d) -> std::byte const* {
+      if constexpr (std::is_same_v<std::decay_t<decltype(d)>, std::shared_ptr<mapped_file const>>)
+        return d->data();
+      else
+        return std::data(d);
+      }, _file_data));
   }
 
   std::optional<font_accessor::gspec_off> const& font_accessor::gpos() const
@@ -133,13 +139,10 @@ namespace goop
 
   font_accessor::font_accessor(std::filesystem::path const& path)
   {
-    std::ifstream file(path, std::ios::binary);
-    file.seekg(0, std::ios::end);
-    _file_size = file.tellg();
-    file.seekg(0);
-    std::vector<std::byte> data(_file_size);
-    file.read(reinterpret_cast<char*>(data.data()), data.size());
-    _file_data = std::move(data);
+    // Fonts opened from the same file share one mapping, only the touched tables are paged in.
+    auto mapping = mapped_file::open(path);
+    _file_size = mapping->size();
+    _file_data = std::move(mapping);
 
     init();
   }
@@ -213,55 +216,93 @@ namespace goop
     std::uint16_t version = reader.r_u16();
     std::uint16_t num_subtables = reader.r_u16();
 
+    // Prefer a full unicode subtable (format 12 or 13) over one that only covers the BMP, otherwise take the first
+    // supported unicode subtable.
+    std::optional<std::uint32_t> selected_offset;
+    int selected_rank = 0;
     for (int i = 0; i < num_subtables; ++i)
     {
       std::uint16_t platform_id = reader.r_u16();
       std::uint16_t encoding_id = reader.r_u16();
       std::uint32_t subtable_offset = reader.r_u32();
 
-      if (platform_id == 0) // unicode
+      bool const unicode = platform_id == 0 || (platform_id == 3 && (encoding_id == 1 || encoding_id == 10));
+      if (!unicode)
+        continue;
+
+      auto const record_position = reader.position();
+      reader.seek_to(*offset + subtable_offset);
+      std::uint16_t const format = reader.r_u16();
+      reader.seek_to(record_position);
+
+      int const rank = (format == 12 || format == 13) ? 2 : (format == 0 || format == 2 || format == 4 || format == 6) ? 1 : 0;
+      if (rank > selected_rank)
       {
-        reader.seek_to(*offset + subtable_offset);
-        std::uint16_t const format = reader.r_u16();
-        std::uint16_t const length = reader.r_u16();
-        std::uint16_t const language = reader.r_u16();
+        selected_rank = rank;
+        selected_offset = subtable_offset;
+      }
+    }
 
-        if (format == 0)
-        {
-          _glyph_indexer = glyph_index_data_f0{ .offset = *offset + subtable_offset };
-        }
-        else if (format == 2)
-        {
-          glyph_index_data_f2 format2{
-            .offset = *offset + subtable_offset
-          };
-          _glyph_indexer = format2;
-        }
-        else if (format == 4)
-        {
-          glyph_index_data_f4 format4{
-            .offset = *offset + subtable_offset,
-            .seg_count_x2 = reader.r_u16(),
-            .search_range = reader.r_u16(),
-            .entry_selector = reader.r_u16(),
-            .range_shift = reader.r_u16(),
-          };
-          _glyph_indexer = format4;
-        }
-        else if (format == 6)
-        {
+    if (!selected_offset)
+      throw std::runtime_error("Detected glyph cmap format not supported.");
 
-          _glyph_indexer = glyph_index_data_f6{
-            .offset = *offset + subtable_offset
-          };
-        }
-        else
-        {
-          throw std::runtime_error("Detected glyph cmap format not supported.");
-        }
+    auto const subtable_offset = *offset + *selected_offset;
+    reader.seek_to(subtable_offset);
+    std::uint16_t const format = reader.r_u16();
 
-        break;
+    if (format == 0)
+    {
+      _glyph_indexer = glyph_index_data_f0{ .offset = subtable_offset };
+    }
+    else if (format == 2)
+    {
+      glyph_index_data_f2 format2{
+        .offset = subtable_offset
+      };
+      _glyph_indexer = format2;
+    }
+    else if (format == 4)
+    {
+      reader.s_u16(); // length
+      reader.s_u16(); // language
+      glyph_index_data_f4 format4{
+        .offset = subtable_offset,
+        .seg_count_x2 = reader.r_u16(),
+        .search_range = reader.r_u16(),
+        .entry_selector = reader.r_u16(),
+        .range_shift = reader.r_u16(),
+      };
+      _glyph_indexer = format4;
+    }
+    else if (format == 6)
+    {
+      _glyph_indexer = glyph_index_data_f6{
+        .offset = subtable_offset
+      };
+    }
+    else if (format == 12 || format == 13)
+    {
+      reader.s_u16(); // reserved
+      reader.s_u32(); // length
+      reader.s_u32(); // language
+      std::uint32_t const num_groups = reader.r_u32();
+
+      glyph_index_data_f12 format12{
+        .offset = subtable_offset,
+        .many_to_one = format == 13
+      };
+      format12.groups.reserve(num_groups);
+      for (std::uint32_t g = 0; g < num_groups; ++g)
+      {
+        cmap_group group;
+        group.first = char32_t(reader.r_u32());
+        group.last = char32_t(reader.r_u32());
+        group.glyph = reader.r_u32();
+        if (group.first <= group.last && group.first <= max_codepoint)
+          format12.groups.push_back(group);
       }
+      std::ranges::sort(format12.groups, std::less<char32_t>{}, &cmap_group::first);
+      _glyph_indexer = std::move(format12);
     }
 
     // GPOS
@@ -320,6 +361,47 @@ namespace goop
       if (major == 1 && minor >= 3)
         _gdef_off.item_var_store_offset = gdef_base.value() + reader.r_u32();
     }
+
+    build_cmap_cache();
+  }
+
+  void font_accessor::build_cmap_cache()
+  {
+    constexpr char32_t bmp_end = 0x10000;
+
+    _cmap_page_index.assign((max_codepoint + 1) / cmap_page_size, 0);
+    _cmap_pages.assign(1, cmap_page{});
+
+    auto const store = [&](char32_t character, glyph_id glyph) {
+      if (glyph == glyph_id::missing)
+        return;
+      auto& page = _cmap_page_index[character / cmap_page_size];
+      if (page == 0)
+      {
+        page = static_cast<std::uint16_t>(_cmap_pages.size());
+        _cmap_pages.emplace_back();
+      }
+      _cmap_pages[page][character % cmap_page_size] = static_cast<std::uint16_t>(glyph);
+    };
+
+    if (auto const* f12 = std::get_if<glyph_index_data_f12>(&_glyph_indexer))
+    {
+      // Only visit the mapped code points, the groups can be sparse over the whole unicode range.
+      for (auto const& group : f12->groups)
+      {
+        for (char32_t c = group.first; c <= std::min(group.last, max_codepoint); ++c)
+          store(c, decode_index(c));
+      }
+    }
+    else
+    {
+      // All other supported subtable formats only map the BMP, code points above stay on the empty page.
+      for (char32_t c = 0; c < bmp_end; ++c)
+        store(c, decode_index(c));
+    }
+
+    auto const& first_page = _cmap_pages[_cmap_page_index[0]];
+    std::copy_n(first_page.begin(), ascii_size, _ascii_glyphs.begin());
   }
 
   std::optional<font_accessor::list_of_uint16_feature> font_accessor::attachment_points(glyph_id glyph) const
@@ -458,6 +540,16 @@ namespace goop
   }
 
   glyph_id font_accessor::index_of(char32_t character) const
+  {
+    if (character < ascii_size)
+      return glyph_id{ _ascii_glyphs[character] };
+    if (character > max_codepoint)
+      return glyph_id::missing;
+
+    return glyph_id{ _cmap_pages[_cmap_page_index[character / cmap_page_size]][character % cmap_page_size] };
+  }
+
+  glyph_id font_accessor::decode_index(char32_t character) const
   {
     auto reader = begin_read();
     if (auto const* f0 = std::get_if<glyph_index_data_f0>(&_glyph_indexer))
@@ -501,7 +593,10 @@ namespace goop
         return char32_t(reader.r_u16());
       };
 
-      auto const bound = std::ranges::lower_bound(std::ranges::views::iota(0, int(f4->seg_count_x2 / 2)), character, std::less<char32_t>{}, map);
+      auto const segments = std::ranges::views::iota(0, int(f4->seg_count_x2 / 2));
+      auto const bound = std::ranges::lower_bound(segments, character, std::less<char32_t>{}, map);
+      if (bound == segments.end())
+        return glyph_id::missing;
       auto const found_index = *bound;
 
       auto const bound_upper = map(found_index);
@@ -539,6 +634,21 @@ namespace goop
       reader.seek_to(reader.position() + index * sizeof(std::uint16_t));
       return glyph_id{ reader.r_u16() };
     }
+    else if (auto const* f12 = std::get_if<glyph_index_data_f12>(&_glyph_indexer))
+    {
+      auto const next = std::ranges::upper_bound(f12->groups, character, std::less<char32_t>{}, &cmap_group::first);
+      if (next == f12->groups.begin())
+        return glyph_id::missing;
+
+      auto const& group = *std::prev(next);
+      if (character > group.last)
+        return glyph_id::missing;
+
+      auto const glyph = f12->many_to_one ? group.glyph : group.glyph + (character - group.first);
+      if (glyph > 0xFFFF)
+        return glyph_id::missing;
+      return glyph_id(glyph);
+    }
     else
     {
       throw std::runtime_error("Detected glyph cmap format not supported.");
@@ -1134,6 +1244,239 @@ namespace goop
       });
   }
 
+  template<typename Fun>
+  void font_accessor::for_each_subtable(std::uint16_t feat, std::optional<gspec_off> const& offset, std::uint16_t extension_type, Fun&& func) const
+  {
+    if (!offset)
+      return;
+
+    auto reader = begin_read();
+    reader.seek_to(offset->feature_list + feat);
+    reader.s_u16(); // feature params offset
+    auto const count = reader.r_u16();
+
+    for (int i = 0; i < count; ++i)
+    {
+      reader.seek_to(offset->feature_list + feat + 2 * sizeof(std::uint16_t) + i * sizeof(std::uint16_t));
+      auto const index = reader.r_u16();
+      reader.seek_to(offset->lookup_list + sizeof(std::uint16_t) + index * sizeof(std::uint16_t));
+      auto const lookup_offset = offset->lookup_list + reader.r_u16();
+
+      reader.seek_to(lookup_offset);
+      auto const lookup_type = reader.r_u16();
+      reader.s_u16(); // lookup flags
+      auto const num_subtables = reader.r_u16();
+
+      for (int sub = 0; sub < num_subtables; ++sub)
+      {
+        reader.seek_to(lookup_offset + 3 * sizeof(std::uint16_t) + sub * sizeof(std::uint16_t));
+        auto const subtable_offset = lookup_offset + reader.r_u16();
+        if (lookup_type != extension_type)
+        {
+          func(lookup_type, subtable_offset);
+          continue;
+        }
+
+        // Extension subtables only wrap the actual subtable to allow 32 bit offsets.
+        reader.seek_to(subtable_offset);
+        reader.s_u16(); // format
+        auto const extension_lookup_type = reader.r_u16();
+        func(extension_lookup_type, subtable_offset + reader.r_u32());
+      }
+    }
+  }
+
+  std::vector<glyph_id> font_accessor::coverage_glyphs(std::size_t offset) const
+  {
+    auto reader = begin_read();
+    reader.seek_to(offset);
+
+    std::vector<glyph_id> glyphs;
+    auto const format = reader.r_u16();
+    if (format == 1)
+    {
+      auto const count = reader.r_u16();
+      glyphs.reserve(count);
+      for (int i = 0; i < count; ++i)
+        glyphs.push_back(glyph_id(reader.r_u16()));
+    }
+    else if (format == 2)
+    {
+      auto const count = reader.r_u16();
+      for (int i = 0; i < count; ++i)
+      {
+        std::size_t const lower = reader.r_u16();
+        std::size_t const upper = reader.r_u16();
+        std::size_t const start_index = reader.r_u16();
+        if (upper < lower)
+          continue;
+
+        glyphs.resize(std::max(glyphs.size(), start_index + upper - lower + 1), glyph_id::missing);
+        for (auto g = lower; g <= upper; ++g)
+          glyphs[start_index + g - lower] = glyph_id(g);
+      }
+    }
+    else
+    {
+      throw std::runtime_error("Unknown coverage format");
+    }
+    return glyphs;
+  }
+
+  std::vector<std::uint16_t> font_accessor::class_table(std::size_t offset) const
+  {
+    auto reader = begin_read();
+    reader.seek_to(offset);
+
+    // Glyphs which are not listed are in class 0.
+    std::vector<std::uint16_t> classes(num_glyphs(), 0);
+    auto const format = reader.r_u16();
+    if (format == 1)
+    {
+      std::size_t const start_glyph = reader.r_u16();
+      auto const count = reader.r_u16();
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        auto const class_val = reader.r_u16();
+        if (start_glyph + i < classes.size())
+          classes[start_glyph + i] = class_val;
+      }
+    }
+    else if (format == 2)
+    {
+      auto const num_ranges = reader.r_u16();
+      for (int i = 0; i < num_ranges; ++i)
+      {
+        std::size_t const lower = reader.r_u16();
+        std::size_t const upper = reader.r_u16();
+        auto const class_val = reader.r_u16();
+        for (auto g = lower; g <= upper && g < classes.size(); ++g)
+          classes[g] = class_val;
+      }
+    }
+    else
+    {
+      throw std::runtime_error("Invalid class format");
+    }
+    return classes;
+  }
+
+  compiled_feature font_accessor::compile_gpos_feature(std::uint16_t feat) const
+  {
+    constexpr std::uint16_t pair_adj = 2;
+    constexpr std::uint16_t extension_pos = 9;
+
+    compiled_feature result;
+    std::size_t subtable = 0;
+    auto reader = begin_read();
+    for_each_subtable(feat, _gpos_off, extension_pos, [&](std::uint16_t type, std::size_t offset) {
+      if (type != pair_adj)
+        return;
+
+      reader.seek_to(offset);
+      auto const fmt = reader.r_u16();
+      auto const coverage = coverage_glyphs(offset + reader.r_u16());
+      auto const value_format_1 = reader.r_u16();
+      auto const value_format_2 = reader.r_u16();
+
+      if (fmt == 1)
+      {
+        auto const num_pair_sets = reader.r_u16();
+        auto const pair_set_offsets = reader.position();
+        for (std::size_t set = 0; set < std::min<std::size_t>(num_pair_sets, coverage.size()); ++set)
+        {
+          reader.seek_to(pair_set_offsets + set * sizeof(std::uint16_t));
+          reader.seek_to(offset + reader.r_u16());
+          auto const pair_value_count = reader.r_u16();
+          for (int p = 0; p < pair_value_count; ++p)
+          {
+            auto const second = glyph_id(reader.r_u16());
+            auto const value_1 = r_value(reader, value_format_1);
+            auto const value_2 = r_value(reader, value_format_2);
+            result._pairs.try_emplace(compiled_feature::pair_key(coverage[set], second),
+              compiled_feature::pair_value{ .value = pair_value_feature(value_1, value_2), .subtable = subtable });
+          }
+        }
+      }
+      else if (fmt == 2)
+      {
+        auto const class_def1 = class_table(offset + reader.r_u16());
+        auto const class_def2_off = reader.r_u16();
+        auto const class_def1_count = reader.r_u16();
+        auto const class_def2_count = reader.r_u16();
+
+        compiled_feature::class_pair_table table{
+          .subtable = subtable,
+          .first_classes = std::vector<std::uint16_t>(num_glyphs(), compiled_feature::no_class),
+          .second_classes = class_table(offset + class_def2_off),
+          .second_class_count = class_def2_count
+        };
+        for (auto const glyph : coverage)
+        {
+          if (std::size_t(glyph) < table.first_classes.size())
+            table.first_classes[std::size_t(glyph)] = class_def1[std::size_t(glyph)];
+        }
+
+        table.values.reserve(std::size_t(class_def1_count) * class_def2_count);
+        for (std::size_t i = 0; i < std::size_t(class_def1_count) * class_def2_count; ++i)
+        {
+          auto const value_1 = r_value(reader, value_format_1);
+          auto const value_2 = r_value(reader, value_format_2);
+          table.values.emplace_back(value_1, value_2);
+        }
+        result._class_pairs.push_back(std::move(table));
+      }
+      else
+      {
+        throw std::runtime_error("Invalid PairPosFormat");
+      }
+      ++subtable;
+      });
+    return result;
+  }
+
+  compiled_feature font_accessor::compile_gsub_feature(std::uint16_t feat) const
+  {
+    constexpr std::uint16_t ligature_sub = 4;
+    constexpr std::uint16_t extension_sub = 7;
+
+    compiled_feature result;
+    std::vector<glyph_id> components;
+    auto reader = begin_read();
+    for_each_subtable(feat, _gsub_off, extension_sub, [&](std::uint16_t type, std::size_t offset) {
+      if (type != ligature_sub)
+        return;
+
+      reader.seek_to(offset);
+      reader.s_u16(); // format
+      auto const coverage = coverage_glyphs(offset + reader.r_u16());
+      auto const lig_set_count = reader.r_u16();
+      auto const lig_set_offsets = reader.position();
+
+      for (std::size_t set = 0; set < std::min<std::size_t>(lig_set_count, coverage.size()); ++set)
+      {
+        reader.seek_to(lig_set_offsets + set * sizeof(std::uint16_t));
+        auto const lig_set = offset + reader.r_u16();
+        reader.seek_to(lig_set);
+        auto const lig_count = reader.r_u16();
+
+        for (int i = 0; i < lig_count; ++i)
+        {
+          reader.seek_to(lig_set + sizeof(std::uint16_t) + i * sizeof(std::uint16_t));
+          reader.seek_to(lig_set + reader.r_u16());
+          auto const ligature = glyph_id(reader.r_u16());
+          auto const num_comps = reader.r_u16();
+
+          components.clear();
+          for (int c = 1; c < num_comps; ++c)
+            components.push_back(glyph_id(reader.r_u16()));
+          result.add_ligature(coverage[set], components, ligature);
+        }
+      }
+      });
+    return result;
+  }
+
   std::optional<std::size_t> font_accessor::seek_table(ptr_reader& reader, font_table tag) const
   {
     auto const offset = table_offset(tag);
@@ -1157,6 +1500,115 @@ namespace goop
     return _type;
   }
 
+  std::optional<font_accessor::pair_value_feature> compiled_feature::kerning(glyph_id first, glyph_id second) const
+  {
+    // Subtables apply in order, a class table only takes precedence over an explicit pair if it comes first.
+    auto const pair = _pairs.find(pair_key(first, second));
+    auto const pair_subtable = pair == _pairs.end() ? std::numeric_limits<std::size_t>::max() : pair->second.subtable;
+
+    for (auto const& table : _class_pairs)
+    {
+      if (table.subtable > pair_subtable)
+        break;
+      if (std::size_t(first) >= table.first_classes.size() || table.first_classes[std::size_t(first)] == no_class)
+        continue;
+
+      auto const second_class = std::size_t(second) < table.second_classes.size() ? table.second_classes[std::size_t(second)] : 0;
+      auto const index = table.first_classes[std::size_t(first)] * table.second_class_count + second_class;
+      if (second_class >= table.second_class_count || index >= table.values.size())
+        continue;
+      return table.values[index];
+    }
+
+    if (pair != _pairs.end())
+      return pair->second.value;
+    return std::nullopt;
+  }
+
+  std::optional<glyph_id> compiled_feature::ligature(std::span<glyph_id const> glyphs) const
+  {
+    if (glyphs.empty())
+      return std::nullopt;
+
+    auto const root = _ligature_roots.find(glyphs[0]);
+    if (root == _ligature_roots.end())
+      return std::nullopt;
+
+    auto node = root->second;
+    for (auto const glyph : glyphs.subspan(1))
+    {
+      auto const& children = _ligature_nodes[node].children;
+      auto const child = std::ranges::lower_bound(children, glyph, {}, &std::pair<glyph_id, std::uint32_t>::first);
+      if (child == children.end() || child->first != glyph)
+        return std::nullopt;
+      node = child->second;
+    }
+
+    if (_ligature_nodes[node].ligature == glyph_id::missing)
+      return std::nullopt;
+    return _ligature_nodes[node].ligature;
+  }
+
+  std::optional<compiled_feature::ligature_match> compiled_feature::longest_ligature(std::span<glyph_id const> glyphs) const
+  {
+    if (glyphs.empty())
+      return std::nullopt;
+
+    auto const root = _ligature_roots.find(glyphs[0]);
+    if (root == _ligature_roots.end())
+      return std::nullopt;
+
+    std::optional<ligature_match> match;
+    auto node = root->second;
+    for (std::size_t length = 1;; ++length)
+    {
+      if (_ligature_nodes[node].ligature != glyph_id::missing)
+        match = ligature_match{ .glyph = _ligature_nodes[node].ligature, .length = length };
+      if (length == glyphs.size())
+        break;
+
+      auto const& children = _ligature_nodes[node].children;
+      auto const child = std::ranges::lower_bound(children, glyphs[length], {}, &std::pair<glyph_id, std::uint32_t>::first);
+      if (child == children.end() || child->first != glyphs[length])
+        break;
+      node = child->second;
+    }
+    return match;
+  }
+
+  std::uint64_t compiled_feature::pair_key(glyph_id first, glyph_id second)
+  {
+    return (std::uint64_t(first) << 32) | std::uint64_t(second);
+  }
+
+  void compiled_feature::add_ligature(glyph_id first, std::span<glyph_id const> components, glyph_id ligature)
+  {
+    auto const [root, inserted] = _ligature_roots.try_emplace(first, std::uint32_t(_ligature_nodes.size()));
+    if (inserted)
+      _ligature_nodes.emplace_back();
+
+    auto node = root->second;
+    for (auto const glyph : components)
+    {
+      auto& children = _ligature_nodes[node].children;
+      auto const child = std::ranges::lower_bound(children, glyph, {}, &std::pair<glyph_id, std::uint32_t>::first);
+      if (child != children.end() && child->first == glyph)
+      {
+        node = child->second;
+        continue;
+      }
+
+      auto const next = std::uint32_t(_ligature_nodes.size());
+      children.emplace(child, glyph, next);
+      _ligature_nodes.emplace_back();
+      node = next;
+    }
+
+    // The first ligature in lookup order wins, like when walking the tables.
+    if (_ligature_nodes[node].ligature == glyph_id::missing)
+      _ligature_nodes[node].ligature = ligature;
+  }
+
   glyph_id font::glyph(char32_t character) const
   {
     return _accessor.index_of(character);
@@ -1250,6 +1702,17 @@ namespace goop
     return _accessor.gsub_feature_lookup(info.offset(), glyphs);
   }
 
+  compiled_feature font::compile_feature(font_feature_info const& info) const
+  {
+    switch (info.type())
+    {
+    case font_feature_type::positioning: return _accessor.compile_gpos_feature(info.offset());
+    case font_feature_type::substitution: return _accessor.compile_gsub_feature(info.offset());
+    default:
+      throw std::invalid_argument("Provided feature has an unknown type");
+    }
+  }
+
   size_t font::substitution_count(font::substitution_feature const& feature) const
   {
     struct
@@ -4,14 +4,17 @@
 #include "font_scripts.hpp"
 #include "font_languages.hpp"
 #include "font_features.hpp"
+#include "mapped_file.hpp"
 
 #include <rnu/math/math.hpp>
 
+#include <array>
 #include <filesystem>
 #include <span>
 #include <any>
 #include <fstream>
 #include <variant>
+#include <unordered_map>
 #include <vector>
 
 namespace goop
@@ -32,6 +35,7 @@ namespace goop
   };
 
   class ptr_reader;
+  class compiled_feature;
 
   class font_accessor
   {
@@ -104,6 +108,8 @@ namespace goop
     horizontal_metric hmetric(glyph_id glyph) const;
     offset_size glyph_offset_size_bytes(glyph_id glyph) const;
     glyph_id index_of(char32_t character) const;
+    // Looks the character up by parsing the cmap subtable, which is what the table behind index_of is built from.
+    glyph_id decode_index(char32_t character) const;
     std::optional<glyph_class> class_of(std::size_t class_table, glyph_id glyph) const;
     std::optional<basic_glyph_class> basic_class_of(glyph_id glyph) const;
     std::optional<list_of_uint16_feature> attachment_points(glyph_id glyph) const;
@@ -117,6 +123,8 @@ namespace goop
     std::optional<std::uint16_t> feature_offset(font_feature feat, std::uint16_t lang, std::optional<gspec_off> const& offset) const;
     std::optional<gpos_feature> gpos_feature_lookup(std::uint16_t feat, std::span<glyph_id const> glyphs) const;
     std::optional<gsub_feature> gsub_feature_lookup(std::uint16_t feat, std::span<glyph_id const> glyphs) const;
+    compiled_feature compile_gpos_feature(std::uint16_t feat) const;
+    compiled_feature compile_gsub_feature(std::uint16_t feat) const;
 
     std::optional<gspec_off> const& gpos() const;
     std::optional<gspec_off> const& gsub() const;
@@ -124,13 +132,23 @@ namespace goop
 
   private:
     void init();
+    void build_cmap_cache();
     std::optional<std::size_t> coverage_index(std::size_t offset, glyph_id glyph) const;
+    std::vector<glyph_id> coverage_glyphs(std::size_t offset) const;
+    std::vector<std::uint16_t> class_table(std::size_t offset) const;
+    template<typename Fun>
+    void for_each_subtable(std::uint16_t feat, std::optional<gspec_off> const& offset, std::uint16_t extension_type, Fun&& func) const;
     value_record r_value(ptr_reader& reader, std::uint16_t flags) const;
 
     static constexpr size_t table_size = 16;
     static constexpr size_t ttf_magic_number = 0x5F0F3CF5;
+    static constexpr char32_t max_codepoint = 0x10FFFF;
+    static constexpr std::size_t cmap_page_size = 256;
+    static constexpr std::size_t ascii_size = 128;
 
-    using data_variant = std::variant<std::vector<std::byte>, std::span<std::byte const>>;
+    using cmap_page = std::array<std::uint16_t, cmap_page_size>;
+
+    using data_variant = std::variant<std::vector<std::byte>, std::span<std::byte const>, std::shared_ptr<mapped_file const>>;
 
     enum class loc_format : uint16_t
     {
@@ -157,11 +175,26 @@ namespace goop
     {
       size_t offset;
     };
+    struct cmap_group
+    {
+      char32_t first;
+      char32_t last;
+      std::uint32_t glyph;
+    };
+    // Formats 12 and 13 only differ in whether a group maps to consecutive glyphs or all to the same one.
+    // The groups are decoded once and sorted by their first code point.
+    struct glyph_index_data_f12
+    {
+      size_t offset;
+      bool many_to_one;
+      std::vector<cmap_group> groups;
+    };
     using glyph_index_data = std::variant<
       glyph_index_data_f0, 
       glyph_index_data_f2,
       glyph_index_data_f4,
-      glyph_index_data_f6>;
+      glyph_index_data_f6,
+      glyph_index_data_f12>;
 
     struct offset_subtable
     {
@@ -223,6 +256,11 @@ namespace goop
     } _maxp;
 
     glyph_index_data _glyph_indexer;
+    // The cmap decoded at init, as a two level table indexed by the high and low bits of a code point.
+    // Page 0 is empty and shared by all code points without glyphs.
+    std::vector<std::uint16_t> _cmap_page_index;
+    std::vector<cmap_page> _cmap_pages;
+    std::array<std::uint16_t, ascii_size> _ascii_glyphs{};
     std::optional<gspec_off>  _gpos_off;
     std::optional<gspec_off>  _gsub_off;
     std::size_t _file_size;
@@ -270,6 +308,59 @@ namespace goop
     std::uint16_t _offset;
   };
 
+  // A positioning or substitution feature decoded into lookup tables once, so that shaping does not walk
+  // the GPOS/GSUB tables for every glyph. Only pair adjustments and ligatures are compiled.
+  class compiled_feature
+  {
+  public:
+    friend class font_accessor;
+
+    struct ligature_match
+    {
+      glyph_id glyph;
+      std::size_t length;
+    };
+
+    std::optional<font_accessor::pair_value_feature> kerning(glyph_id first, glyph_id second) const;
+    std::optional<glyph_id> ligature(std::span<glyph_id const> glyphs) const;
+    // The longest ligature formed by the glyphs at the start of the given range.
+    std::optional<ligature_match> longest_ligature(std::span<glyph_id const> glyphs) const;
+
+  private:
+    static constexpr std::uint16_t no_class = 0xFFFF;
+
+    struct pair_value
+    {
+      font_accessor::pair_value_feature value;
+      std::size_t subtable;
+    };
+
+    // Class based pair adjustments, with the classes of all glyphs expanded.
+    struct class_pair_table
+    {
+      std::size_t subtable;
+      std::vector<std::uint16_t> first_classes;
+      std::vector<std::uint16_t> second_classes;
+      std::size_t second_class_count;
+      std::vector<font_accessor::pair_value_feature> values;
+    };
+
+    // Ligature components after the first glyph, children are sorted by glyph.
+    struct ligature_node
+    {
+      glyph_id ligature = glyph_id::missing;
+      std::vector<std::pair<glyph_id, std::uint32_t>> children;
+    };
+
+    static std::uint64_t pair_key(glyph_id first, glyph_id second);
+    void add_ligature(glyph_id first, std::span<glyph_id const> components, glyph_id ligature);
+
+    std::unordered_map<std::uint64_t, pair_value> _pairs;
+    std::vector<class_pair_table> _class_pairs;
+    std::unordered_map<glyph_id, std::uint32_t> _ligature_roots;
+    std::vector<ligature_node> _ligature_nodes;
+  };
+
   template<typename T, std::size_t Size>
   struct stack_buffer;
 
@@ -308,6 +399,7 @@ namespace goop
 
     std::optional<positioning_feature> lookup_positioning(font_feature_info const& info, std::span<glyph_id const> glyphs) const;
     std::optional<substitution_feature> lookup_substitution(font_feature_info const& info, std::span<glyph_id const> glyphs) const;
+    compiled_feature compile_feature(font_feature_info const& info) const;
 
     size_t substitution_count(substitution_feature const& feature) const;
     glyph_id substitution_glyph(substitution_feature const& feature, std::size_t index) const;
@@ -0,0 +1,110 @@
+#include "mapped_file.hpp"
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace goop
+{
+  std::shared_ptr<mapped_file const> mapped_file::open(std::filesystem::path const& path)
+  {
+    static std::mutex mutex;
+    static std::map<std::filesystem::path, std::weak_ptr<mapped_file const>> mappings;
+
+    auto const key = std::filesystem::weakly_canonical(path);
+    std::unique_lock lock(mutex);
+    if (auto const existing = mappings[key].lock())
+      return existing;
+
+    std::erase_if(mappings, [](auto const& entry) { return entry.second.expired(); });
+    std::shared_ptr<mapped_file const> file(new mapped_file(key));
+    mappings[key] = file;
+    return file;
+  }
+
+#if defined(_WIN32)
+  mapped_file::mapped_file(std::filesystem::path const& path)
+  {
+    HANDLE const file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      throw std::runtime_error("Could not open file for mapping.");
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+      CloseHandle(file);
+      throw std::runtime_error("Could not map an empty file.");
+    }
+
+    // The mapping object keeps the file open, the file handle itself is not needed anymore.
+    HANDLE const mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+      throw std::runtime_error("Could not create file mapping.");
+
+    auto const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+      CloseHandle(mapping);
+      throw std::runtime_error("Could not map view of file.");
+    }
+
+    _data = static_cast<std::byte const*>(view);
+    _size = static_cast<std::size_t>(size.QuadPart);
+    _mapping_handle = mapping;
+  }
+
+  mapped_file::~mapped_file()
+  {
+    UnmapViewOfFile(_data);
+    CloseHandle(_mapping_handle);
+  }
+#else
+  mapped_file::mapped_file(std::filesystem::path const& path)
+  {
+    int const file = ::open(path.c_str(), O_RDONLY);
+    if (file == -1)
+      throw std::runtime_error("Could not open file for mapping.");
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+      close(file);
+      throw std::runtime_error("Could not map an empty file.");
+    }
+
+    auto const view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (view == MAP_FAILED)
+      throw std::runtime_error("Could not map view of file.");
+
+    _data = static_cast<std::byte const*>(view);
+    _size = static_cast<std::size_t>(info.st_size);
+  }
+
+  mapped_file::~mapped_file()
+  {
+    munmap(const_cast<std::byte*>(_data), _size);
+  }
+#endif
+
+  std::byte const* mapped_file::data() const
+  {
+    return _data;
+  }
+
+  std::size_t mapped_file::size() const
+  {
+    return _size;
+  }
+}
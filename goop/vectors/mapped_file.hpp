@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace goop
+{
+  // A read-only view of a whole file, mapped into memory instead of being read into a buffer.
+  // Pages are only loaded by the OS when they are touched, and opening the same file again while a
+  // mapping is still alive returns the existing one.
+  class mapped_file
+  {
+  public:
+    static std::shared_ptr<mapped_file const> open(std::filesystem::path const& path);
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+    ~mapped_file();
+
+    std::byte const* data() const;
+    std::size_t size() const;
+
+  private:
+    explicit mapped_file(std::filesystem::path const& path);
+
+    std::byte const* _data = nullptr;
+    std::size_t _size = 0;
+    void* _mapping_handle = nullptr;
+  };
+}
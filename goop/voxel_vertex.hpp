@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include "geometry.hpp"
+
+namespace goop
+{
+  enum class voxel_face : std::uint8_t
+  {
+    x_pos,
+    x_neg,
+    y_pos,
+    y_neg,
+    z_pos,
+    z_neg
+  };
+
+  // Compact vertex for block geometry. The position is the chunk-local block corner, normals and
+  // texture coordinates are derived from the face in the shader.
+  // position_face bits: x [0, 6), y [6, 12), z [12, 18), face [18, 21), ambient occlusion [21, 23)
+  struct voxel_vertex
+  {
+    static constexpr std::uint32_t max_position = 63;
+    static constexpr std::uint32_t max_occlusion = 3;
+
+    std::uint32_t position_face;
+    std::uint32_t material;
+
+    static constexpr voxel_vertex pack(std::uint32_t x, std::uint32_t y, std::uint32_t z, voxel_face face, std::uint32_t occlusion, std::uint16_t material)
+    {
+      return voxel_vertex{
+        .position_face = (x & 63) | ((y & 63) << 6) | ((z & 63) << 12) | ((static_cast<std::uint32_t>(face) & 7) << 18) | ((occlusion & 3) << 21),
+        .material = material
+      };
+    }
+
+    constexpr std::uint32_t x() const { return position_face & 63; }
+    constexpr std::uint32_t y() const { return (position_face >> 6) & 63; }
+    constexpr std::uint32_t z() const { return (position_face >> 12) & 63; }
+    constexpr voxel_face face() const { return static_cast<voxel_face>((position_face >> 18) & 7); }
+    constexpr std::uint32_t occlusion() const { return (position_face >> 21) & 3; }
+  };
+  static_assert(sizeof(voxel_vertex) == 8);
+
+  void set_vertex_format(geometry_format_base& format, std::size_t binding, std::type_identity<voxel_vertex>);
+
+  extern template class basic_geometry<voxel_vertex>;
+
+  using voxel_geometry = handle<basic_geometry<voxel_vertex>, basic_geometry<voxel_vertex>>;
+}